@@ -256,6 +256,7 @@ void VehicleCargoList::Append(CargoPacket *cp, MoveToAction action)
 	assert(cp != nullptr);
 	assert(action == MTA_LOAD ||
 			(action == MTA_KEEP && this->action_counts[MTA_LOAD] == 0));
+	this->ApplyPendingAge();
 	this->AddToMeta(cp, action);
 
 	if (this->count == cp->count) {
@@ -380,18 +381,40 @@ void VehicleCargoList::AddToMeta(const CargoPacket *cp, MoveToAction action)
 }
 
 /**
- * Ages the all cargo in this list.
+ * Returns average number of days in transit for a cargo entity, including
+ * the ageing that was not applied to the packets yet.
+ * @return The before mentioned number.
  */
-void VehicleCargoList::AgeCargo()
+uint VehicleCargoList::DaysInTransit() const
 {
+	if (this->count == 0 || this->pending_age == 0) return this->Parent::DaysInTransit();
+
+	uint days_in_transit = 0;
+	for (ConstIterator it(this->packets.begin()); it != this->packets.end(); it++) {
+		const CargoPacket *cp = *it;
+		days_in_transit += min<uint>(cp->days_in_transit + this->pending_age, 0xFF) * cp->count;
+	}
+	return days_in_transit / this->count;
+}
+
+/**
+ * Applies the ageing that was deferred by AgeCargo to the packets. This has
+ * to happen before packets are merged, paid for or leave this list.
+ */
+void VehicleCargoList::ApplyPendingAge()
+{
+	if (this->pending_age == 0) return;
+
 	for (ConstIterator it(this->packets.begin()); it != this->packets.end(); it++) {
 		CargoPacket *cp = *it;
 		/* If we're at the maximum, then we can't increase no more. */
 		if (cp->days_in_transit == 0xFF) continue;
 
-		cp->days_in_transit++;
-		this->cargo_days_in_transit += cp->count;
+		byte days_in_transit = min<uint>(cp->days_in_transit + this->pending_age, 0xFF);
+		this->cargo_days_in_transit += (days_in_transit - cp->days_in_transit) * cp->count;
+		cp->days_in_transit = days_in_transit;
 	}
+	this->pending_age = 0;
 }
 
 /**
@@ -449,6 +472,7 @@ void VehicleCargoList::SetTransferLoadPlace(TileIndex xy)
  */
 bool VehicleCargoList::Stage(bool accepted, StationID current_station, StationIDStack next_station, uint8 order_flags, const GoodsEntry *ge, CargoPayment *payment)
 {
+	this->ApplyPendingAge();
 	this->AssertCountConsistency();
 	assert(this->action_counts[MTA_LOAD] == 0);
 	this->action_counts[MTA_TRANSFER] = this->action_counts[MTA_DELIVER] = this->action_counts[MTA_KEEP] = 0;
@@ -607,6 +631,7 @@ uint VehicleCargoList::Reassign<VehicleCargoList::MTA_DELIVER, VehicleCargoList:
  */
 uint VehicleCargoList::Return(uint max_move, StationCargoList *dest, StationID next)
 {
+	this->ApplyPendingAge();
 	max_move = min(this->action_counts[MTA_LOAD], max_move);
 	this->PopCargo(CargoReturn(this, dest, max_move, next));
 	return max_move;
@@ -620,6 +645,7 @@ uint VehicleCargoList::Return(uint max_move, StationCargoList *dest, StationID n
  */
 uint VehicleCargoList::Shift(uint max_move, VehicleCargoList *dest)
 {
+	this->ApplyPendingAge();
 	max_move = min(this->count, max_move);
 	this->PopCargo(CargoShift(this, dest, max_move));
 	return max_move;
@@ -635,6 +661,7 @@ uint VehicleCargoList::Shift(uint max_move, VehicleCargoList *dest)
  */
 uint VehicleCargoList::Unload(uint max_move, StationCargoList *dest, CargoPayment *payment)
 {
+	this->ApplyPendingAge();
 	uint moved = 0;
 	if (this->action_counts[MTA_TRANSFER] > 0) {
 		uint move = min(this->action_counts[MTA_TRANSFER], max_move);
@@ -672,6 +699,10 @@ uint VehicleCargoList::Truncate(uint max_move)
  */
 uint VehicleCargoList::Reroute(uint max_move, VehicleCargoList *dest, StationID avoid, StationID avoid2, const GoodsEntry *ge)
 {
+	if (dest != this) {
+		this->ApplyPendingAge();
+		dest->ApplyPendingAge();
+	}
 	max_move = min(this->action_counts[MTA_TRANSFER], max_move);
 	this->ShiftCargo(VehicleCargoReroute(this, dest, max_move, avoid, avoid2, ge));
 	return max_move;
@@ -777,39 +808,57 @@ uint StationCargoList::Truncate(uint max_move, StationCargoAmountMap *cargo_per_
 	uint moved = 0;
 	uint loop = 0;
 	bool do_count = cargo_per_source != nullptr;
+	bool done = false;
 	while (max_move > moved) {
-		for (Iterator it(this->packets.begin()); it != this->packets.end();) {
-			CargoPacket *cp = *it;
-			if (prev_count > max_move && RandomRange(prev_count) < prev_count - max_move) {
-				if (do_count && loop == 0) {
-					(*cargo_per_source)[cp->source] += cp->count;
+		for (StationCargoPacketMap::MapIterator map_it(this->packets.Map::begin()); map_it != this->packets.Map::end();) {
+			/* The packets that are kept are moved to the front of the list,
+			 * so the list is only shortened once per next hop instead of
+			 * moving all packets behind every removed one. */
+			StationCargoPacketMap::List &list = map_it->second;
+			StationCargoPacketMap::ListIterator kept(list.begin());
+			for (StationCargoPacketMap::ListIterator it(list.begin()); it != list.end(); ++it) {
+				CargoPacket *cp = *it;
+				if (done) {
+					*kept++ = cp;
+					continue;
 				}
-				++it;
-				continue;
-			}
-			uint diff = max_move - moved;
-			if (cp->count > diff) {
-				if (diff > 0) {
-					this->RemoveFromCache(cp, diff);
-					cp->Reduce(diff);
-					moved += diff;
+				if (prev_count > max_move && RandomRange(prev_count) < prev_count - max_move) {
+					if (do_count && loop == 0) {
+						(*cargo_per_source)[cp->source] += cp->count;
+					}
+					*kept++ = cp;
+					continue;
 				}
-				if (loop > 0) {
-					if (do_count) (*cargo_per_source)[cp->source] -= diff;
-					return moved;
+				uint diff = max_move - moved;
+				if (cp->count > diff) {
+					if (diff > 0) {
+						this->RemoveFromCache(cp, diff);
+						cp->Reduce(diff);
+						moved += diff;
+					}
+					if (loop > 0) {
+						if (do_count) (*cargo_per_source)[cp->source] -= diff;
+						done = true;
+					} else {
+						if (do_count) (*cargo_per_source)[cp->source] += cp->count;
+					}
+					*kept++ = cp;
 				} else {
-					if (do_count) (*cargo_per_source)[cp->source] += cp->count;
-					++it;
+					if (do_count && loop > 0) {
+						(*cargo_per_source)[cp->source] -= cp->count;
+					}
+					moved += cp->count;
+					this->RemoveFromCache(cp, cp->count);
+					delete cp;
 				}
+			}
+			list.erase(kept, list.end());
+			if (list.empty()) {
+				this->packets.Map::erase(map_it++);
 			} else {
-				it = this->packets.erase(it);
-				if (do_count && loop > 0) {
-					(*cargo_per_source)[cp->source] -= cp->count;
-				}
-				moved += cp->count;
-				this->RemoveFromCache(cp, cp->count);
-				delete cp;
+				++map_it;
 			}
+			if (done) return moved;
 		}
 		loop++;
 	}
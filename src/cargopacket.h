@@ -19,6 +19,7 @@
 #include "cargo_type.h"
 #include "vehicle_type.h"
 #include "core/multimap.hpp"
+#include "core/flatqueue_type.hpp"
 #include <list>
 
 /** Unique identifier for a single cargo packet. */
@@ -287,6 +288,7 @@ protected:
 
 	Money feeder_share;                     ///< Cache for the feeder share.
 	uint action_counts[NUM_MOVE_TO_ACTION]; ///< Counts of cargo to be transferred, delivered, kept and loaded.
+	byte pending_age;                       ///< Number of times the cargo was aged without updating the packets, up to 0xFF.
 
 	template<class Taction>
 	void ShiftCargo(Taction action);
@@ -404,9 +406,20 @@ public:
 		return this->action_counts[MTA_KEEP] + this->action_counts[MTA_LOAD];
 	}
 
+	uint DaysInTransit() const;
+
 	void Append(CargoPacket *cp, MoveToAction action = MTA_KEEP);
 
-	void AgeCargo();
+	/**
+	 * Ages the all cargo in this list. The packets are only brought up to date
+	 * once cargo is moved, so ageing does not depend on the number of packets.
+	 */
+	inline void AgeCargo()
+	{
+		if (this->pending_age < 0xFF) this->pending_age++;
+	}
+
+	void ApplyPendingAge();
 
 	void InvalidateCache();
 
@@ -454,7 +467,7 @@ public:
 	}
 };
 
-typedef MultiMap<StationID, CargoPacket *> StationCargoPacketMap;
+typedef MultiMap<StationID, CargoPacket *, std::less<StationID>, FlatQueue<CargoPacket *> > StationCargoPacketMap;
 typedef std::map<StationID, uint> StationCargoAmountMap;
 
 /**
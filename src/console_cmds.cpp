@@ -38,6 +38,7 @@
 #include "console_func.h"
 #include "engine_base.h"
 #include "game/game.hpp"
+#include "linkgraph/linkgraphschedule.h"
 #include "table/strings.h"
 #include <time.h>
 
@@ -1902,6 +1903,124 @@ DEF_CONSOLE_CMD(ConFramerate)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConYapfCacheStats)
+{
+	extern void ConPrintYapfCacheStats(bool reset); // pathfinder/yapf/yapf_rail.cpp
+	extern void ConPrintTrainReservationCacheStats(bool reset); // pbs.cpp
+
+	if (argc == 0 || argc > 2 || (argc == 2 && strcmp(argv[1], "reset") != 0)) {
+		IConsoleHelp("Show hits, misses and invalidations of the YAPF rail segment cost cache and the train reservation cache. Usage: 'yapf_cache [reset]'");
+		IConsoleHelp("  'reset' clears the statistics after showing them");
+		return true;
+	}
+
+	ConPrintYapfCacheStats(argc == 2);
+	ConPrintTrainReservationCacheStats(argc == 2);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConPfBenchmark)
+{
+	extern bool StartPfBenchmarkRecording(uint ticks, const char *name); // pathfinder/pf_benchmark.cpp
+	extern bool StartPfBenchmarkReplay(const char *name); // pathfinder/pf_benchmark.cpp
+
+	if (argc == 0) {
+		IConsoleHelp("Record the track choices of all vehicles, or replay each of them in isolation where the game asks it again. Usage: 'pf_benchmark record <ticks> <name>' or 'pf_benchmark replay <name>'");
+		IConsoleHelp("  'record' saves the game as <name>.sav and the queries of the next <ticks> game ticks as <name>.pfq");
+		IConsoleHelp("  'replay' must directly follow loading <name>.sav and refuses to run when the date or random state of the game differ from the recording");
+		IConsoleHelp("  Each query is replayed by the path finder the game is set to use, with the segment cache of YAPF as the game has it and with an empty one; the nodes, cache hits and latencies of both are reported as 'yapf' debug output after <ticks> game ticks");
+		IConsoleHelp("  For a headless replay put it in scripts/game_start.scr and start 'openttd -g <name>.sav -v null:ticks=<n> -s null -m null'");
+		return true;
+	}
+
+	if (_game_mode != GM_NORMAL) {
+		IConsoleError("Path finder queries can only be recorded and replayed in a running game");
+		return true;
+	}
+
+	if (argc == 4 && strcmp(argv[1], "record") == 0) {
+		uint32 ticks;
+		if (!GetArgumentInteger(&ticks, argv[2]) || ticks == 0) return false;
+		if (StartPfBenchmarkRecording(ticks, argv[3])) IConsolePrintF(CC_DEFAULT, "Recording path finder queries for %u ticks", ticks);
+		return true;
+	}
+
+	if (argc == 3 && strcmp(argv[1], "replay") == 0) {
+		if (StartPfBenchmarkReplay(argv[2])) IConsolePrintF(CC_DEFAULT, "Replaying path finder queries of '%s'", argv[2]);
+		return true;
+	}
+
+	return false;
+}
+
+DEF_CONSOLE_CMD(ConCatchmentBenchmark)
+{
+	extern void BenchmarkCatchmentIndex(); // station_cmd.cpp
+
+	if (argc == 0) {
+		IConsoleHelp("Find the stations around all houses and industries with the catchment index and by scanning the area around them, and compare both. Usage: 'catchment_benchmark'");
+		return true;
+	}
+
+	if (_game_mode != GM_NORMAL) {
+		IConsoleError("The catchment index can only be benchmarked in a running game");
+		return true;
+	}
+
+	BenchmarkCatchmentIndex();
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConMapBenchmark)
+{
+	extern void BenchmarkMap(uint rounds); // landscape.cpp
+
+	if (argc == 0) {
+		IConsoleHelp("Time the map accesses of the tile loop, the smallmap and terraforming without changing the map. Usage: 'map_benchmark [<rounds>]'");
+		IConsoleHelp("  Compare the results of builds with and without --enable-map-planes on the same savegame");
+		return true;
+	}
+
+	uint32 rounds = 10;
+	if (argc > 2 || (argc == 2 && (!GetArgumentInteger(&rounds, argv[1]) || rounds == 0))) return false;
+
+	if (_game_mode != GM_NORMAL) {
+		IConsoleError("The map can only be benchmarked in a running game");
+		return true;
+	}
+
+	BenchmarkMap(rounds);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConLinkGraphBenchmark)
+{
+	if (argc == 0) {
+		IConsoleHelp("Generate a link graph component and time its calculation, without changing the game. Usage: 'linkgraph_benchmark <nodes> [<degree> [<runs>]]'");
+		IConsoleHelp("  Each node gets up to <degree> links to nodes near it. Passengers have to use cargo distribution");
+		return true;
+	}
+
+	uint32 nodes;
+	uint32 degree = 4;
+	uint32 runs = 3;
+	if (argc < 2 || argc > 4 || !GetArgumentInteger(&nodes, argv[1]) || nodes < 2 || nodes >= INVALID_NODE) return false;
+	if (argc > 2 && !GetArgumentInteger(&degree, argv[2])) return false;
+	if (argc > 3 && (!GetArgumentInteger(&runs, argv[3]) || runs == 0)) return false;
+
+	if (_game_mode != GM_NORMAL) {
+		IConsoleError("The link graph can only be benchmarked in a running game");
+		return true;
+	}
+	if (_settings_game.linkgraph.GetDistributionType(CT_PASSENGERS) == DT_MANUAL) {
+		IConsoleError("Passengers are distributed manually; set linkgraph.distribution_pax to symmetric or asymmetric first");
+		return true;
+	}
+
+	LinkGraphSchedule::Benchmark(nodes, degree, runs);
+	return true;
+}
+
 DEF_CONSOLE_CMD(ConFramerateWindow)
 {
 	extern void ShowFramerateWindow();
@@ -2052,6 +2171,11 @@ void IConsoleStdLibRegister()
 #endif
 	IConsoleCmdRegister("fps",     ConFramerate);
 	IConsoleCmdRegister("fps_wnd", ConFramerateWindow);
+	IConsoleCmdRegister("yapf_cache", ConYapfCacheStats);
+	IConsoleCmdRegister("pf_benchmark", ConPfBenchmark, ConHookNoNetwork);
+	IConsoleCmdRegister("catchment_benchmark", ConCatchmentBenchmark);
+	IConsoleCmdRegister("map_benchmark", ConMapBenchmark);
+	IConsoleCmdRegister("linkgraph_benchmark", ConLinkGraphBenchmark, ConHookNoNetwork);
 
 	/* NewGRF development stuff */
 	IConsoleCmdRegister("reload_newgrfs",  ConNewGRFReload, ConHookNewGRFDeveloperTool);
@@ -0,0 +1,125 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file flatmap_type.hpp Map storing its items sorted by key in a contiguous array. */
+
+#ifndef FLATMAP_TYPE_HPP
+#define FLATMAP_TYPE_HPP
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * Map that keeps its items sorted by key in a vector. Lookups are binary
+ * searches with the same results as the ones of std::map. Inserting keys in
+ * ascending order is cheap; inserting a key anywhere else moves all items
+ * behind it. Unlike std::map, the keys of the items may be changed as long as
+ * their order is kept.
+ *
+ * Iterators are invalidated by inserting and removing items.
+ *
+ * @tparam T Key type.
+ * @tparam U Value type.
+ */
+template <typename T, typename U>
+struct FlatMap : std::vector<std::pair<T, U> > {
+	typedef std::pair<T, U> Pair;
+	typedef std::vector<Pair> Storage;
+	typedef typename Storage::iterator iterator;
+	typedef typename Storage::const_iterator const_iterator;
+
+	/**
+	 * Find the first item whose key is not less than the given key.
+	 * @param key Key to look for.
+	 * @return Iterator to the item, or end() if there is none.
+	 */
+	inline iterator lower_bound(const T &key)
+	{
+		return std::lower_bound(this->begin(), this->end(), key, &FlatMap::ItemLess);
+	}
+
+	/**
+	 * Find the first item whose key is not less than the given key.
+	 * @param key Key to look for.
+	 * @return Iterator to the item, or end() if there is none.
+	 */
+	inline const_iterator lower_bound(const T &key) const
+	{
+		return std::lower_bound(this->begin(), this->end(), key, &FlatMap::ItemLess);
+	}
+
+	/**
+	 * Find the first item whose key is greater than the given key.
+	 * @param key Key to look for.
+	 * @return Iterator to the item, or end() if there is none.
+	 */
+	inline iterator upper_bound(const T &key)
+	{
+		return std::upper_bound(this->begin(), this->end(), key, &FlatMap::KeyLess);
+	}
+
+	/**
+	 * Find the first item whose key is greater than the given key.
+	 * @param key Key to look for.
+	 * @return Iterator to the item, or end() if there is none.
+	 */
+	inline const_iterator upper_bound(const T &key) const
+	{
+		return std::upper_bound(this->begin(), this->end(), key, &FlatMap::KeyLess);
+	}
+
+	/**
+	 * Find the item with the given key.
+	 * @param key Key to look for.
+	 * @return Iterator to the item, or end() if there is none.
+	 */
+	inline iterator find(const T &key)
+	{
+		iterator it = this->lower_bound(key);
+		return (it != this->end() && !(key < it->first)) ? it : this->end();
+	}
+
+	/**
+	 * Find the item with the given key.
+	 * @param key Key to look for.
+	 * @return Iterator to the item, or end() if there is none.
+	 */
+	inline const_iterator find(const T &key) const
+	{
+		const_iterator it = this->lower_bound(key);
+		return (it != this->end() && !(key < it->first)) ? it : this->end();
+	}
+
+	/**
+	 * Get the value of the item with the given key, adding the item if it
+	 * doesn't exist yet.
+	 * @param key Key of the item.
+	 * @return Reference to the value of the item.
+	 */
+	inline U &operator[](const T &key)
+	{
+		/* Keys are mostly added in ascending order. */
+		if (this->empty() || this->back().first < key) {
+			this->push_back(Pair(key, U()));
+			return this->back().second;
+		}
+		iterator it = this->lower_bound(key);
+		if (key < it->first) it = this->insert(it, Pair(key, U()));
+		return it->second;
+	}
+
+private:
+	/** Compare the key of an item with a key. */
+	static inline bool ItemLess(const Pair &item, const T &key) { return item.first < key; }
+
+	/** Compare a key with the key of an item. */
+	static inline bool KeyLess(const T &key, const Pair &item) { return key < item.first; }
+};
+
+#endif /* FLATMAP_TYPE_HPP */
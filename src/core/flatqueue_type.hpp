@@ -0,0 +1,125 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file flatqueue_type.hpp Contiguous queue for items that are mostly appended at the back and removed at the front. */
+
+#ifndef FLATQUEUE_TYPE_HPP
+#define FLATQUEUE_TYPE_HPP
+
+#include <vector>
+
+/**
+ * Queue that stores its items contiguously, with the STL-style interface of
+ * a list. Items are appended at the back. Removing the first item only moves
+ * the start of the queue; the space in front is reclaimed once it makes up
+ * half of the storage. Removing any other item moves the items behind it.
+ *
+ * Iterators are invalidated by appending items and by removing items, except
+ * for the iterators to items in front of a removed item that is not the first.
+ *
+ * @tparam T Type of the items.
+ */
+template <typename T>
+class FlatQueue {
+private:
+	typedef std::vector<T> Storage;
+
+	static const size_t MIN_COMPACT_HEAD = 32; ///< Minimum number of removed items in front before the storage is compacted.
+
+	Storage items; ///< The items, including the removed ones in front of #head.
+	size_t head;   ///< Position of the first item in #items.
+
+public:
+	typedef T value_type;
+	typedef typename Storage::iterator iterator;
+	typedef typename Storage::const_iterator const_iterator;
+	typedef typename Storage::reverse_iterator reverse_iterator;
+	typedef typename Storage::const_reverse_iterator const_reverse_iterator;
+
+	FlatQueue() : head(0) {}
+
+	inline iterator begin() { return this->items.begin() + this->head; }
+	inline iterator end() { return this->items.end(); }
+	inline const_iterator begin() const { return this->items.begin() + this->head; }
+	inline const_iterator end() const { return this->items.end(); }
+	inline reverse_iterator rbegin() { return this->items.rbegin(); }
+	inline reverse_iterator rend() { return reverse_iterator(this->begin()); }
+	inline const_reverse_iterator rbegin() const { return this->items.rbegin(); }
+	inline const_reverse_iterator rend() const { return const_reverse_iterator(this->begin()); }
+
+	inline bool empty() const { return this->head == this->items.size(); }
+	inline size_t size() const { return this->items.size() - this->head; }
+
+	inline T &front() { return this->items[this->head]; }
+	inline const T &front() const { return this->items[this->head]; }
+	inline T &back() { return this->items.back(); }
+	inline const T &back() const { return this->items.back(); }
+
+	/**
+	 * Append an item at the back of the queue.
+	 * @param item The item.
+	 */
+	inline void push_back(const T &item)
+	{
+		this->items.push_back(item);
+	}
+
+	/**
+	 * Remove an item from the queue.
+	 * @param pos Iterator to the item.
+	 * @return Iterator to the item behind the removed one.
+	 */
+	iterator erase(iterator pos)
+	{
+		if (pos != this->begin()) return this->items.erase(pos);
+
+		this->head++;
+		if (this->head == this->items.size()) {
+			this->clear();
+		} else if (this->head >= MIN_COMPACT_HEAD && this->head * 2 >= this->items.size()) {
+			this->items.erase(this->items.begin(), this->items.begin() + this->head);
+			this->head = 0;
+		}
+		return this->begin();
+	}
+
+	/**
+	 * Remove a range of items from the queue.
+	 * @param first Iterator to the first item to remove.
+	 * @param last Iterator behind the last item to remove.
+	 * @return Iterator to the item behind the removed ones.
+	 */
+	iterator erase(iterator first, iterator last)
+	{
+		if (first == this->begin() && last == this->end()) {
+			this->clear();
+			return this->end();
+		}
+		return this->items.erase(first, last);
+	}
+
+	/** Remove all items. */
+	inline void clear()
+	{
+		this->items.clear();
+		this->head = 0;
+	}
+
+	/**
+	 * Swap the items with another queue.
+	 * @param other The other queue.
+	 */
+	inline void swap(FlatQueue &other)
+	{
+		this->items.swap(other.items);
+		std::swap(this->head, other.head);
+	}
+};
+
+#endif /* FLATQUEUE_TYPE_HPP */
@@ -17,6 +17,13 @@
 #include "core/pool_func.hpp"
 #include "vehicle_gui.h"
 #include "vehiclelist.h"
+#include "depot_func.h"
+#include "depot_map.h"
+#include "rail_map.h"
+#include "road_map.h"
+#include "water_map.h"
+#include "map_func.h"
+#include <algorithm>
 
 #include "safeguards.h"
 
@@ -29,6 +36,8 @@ INSTANTIATE_POOL_METHODS(Depot)
  */
 Depot::~Depot()
 {
+	InvalidateDepotDistanceFields();
+
 	if (CleaningPool()) return;
 
 	if (!IsDepotTile(this->xy) || GetDepotIndex(this->xy) != this->index) {
@@ -49,3 +58,174 @@ Depot::~Depot()
 	VehicleType vt = GetDepotVehicleType(this->xy);
 	DeleteWindowById(GetWindowClassForVehicleType(vt), VehicleListIdentifier(VL_DEPOT_LIST, vt, GetTileOwner(this->xy), this->index).Pack());
 }
+
+static const uint DEPOT_FIELD_CELL_BITS = 4;                           ///< Log2 of the size of the cells of a depot distance field, in tiles.
+static const uint DEPOT_FIELD_CELL_SIZE = 1 << DEPOT_FIELD_CELL_BITS; ///< Size of the cells of a depot distance field, in tiles.
+
+/**
+ * Coarse distance field of the depots of one company for one transport type.
+ * The map is divided into cells of #DEPOT_FIELD_CELL_SIZE by #DEPOT_FIELD_CELL_SIZE
+ * tiles; every cell holds the Manhattan distance in cells to the nearest cell with
+ * a depot. That gives a lower bound of the distance to the nearest depot, which
+ * lets depot searches skip the path finder when no depot can be close enough.
+ * The field ignores the track layout, so only building, removing and taking
+ * over depots changes it.
+ */
+struct DepotDistanceField {
+	bool valid;                   ///< Whether the field matches the depots on the map.
+	std::vector<DepotID> depots;  ///< The depots, sorted by index.
+	std::vector<uint16> distance; ///< Per cell the distance to the nearest cell with a depot; empty without depots.
+};
+
+/** The depot distance fields of rail, road and water depots of all companies. */
+static DepotDistanceField _depot_distance_fields[MAX_COMPANIES][TRANSPORT_WATER + 1];
+
+/**
+ * Get the cell of a depot distance field a tile is in.
+ * @param tile The tile.
+ * @return Index of the cell.
+ */
+static inline uint GetDepotFieldCell(TileIndex tile)
+{
+	return (TileY(tile) >> DEPOT_FIELD_CELL_BITS) * (MapSizeX() >> DEPOT_FIELD_CELL_BITS) + (TileX(tile) >> DEPOT_FIELD_CELL_BITS);
+}
+
+/**
+ * Spread the distances of a depot distance field from the given cells.
+ * @param field The field.
+ * @param queue Cells whose distance was lowered; used as queue.
+ */
+static void SpreadDepotDistance(DepotDistanceField &field, std::vector<uint> &queue)
+{
+	uint cells_x = MapSizeX() >> DEPOT_FIELD_CELL_BITS;
+	uint cells_y = MapSizeY() >> DEPOT_FIELD_CELL_BITS;
+
+	for (size_t i = 0; i < queue.size(); i++) {
+		uint cell = queue[i];
+		uint x = cell % cells_x;
+		uint y = cell / cells_x;
+		uint16 next = field.distance[cell] + 1;
+
+		auto visit = [&](uint neighbour) {
+			if (next >= field.distance[neighbour]) return;
+			field.distance[neighbour] = next;
+			queue.push_back(neighbour);
+		};
+		if (x > 0) visit(cell - 1);
+		if (x + 1 < cells_x) visit(cell + 1);
+		if (y > 0) visit(cell - cells_x);
+		if (y + 1 < cells_y) visit(cell + cells_x);
+	}
+}
+
+/**
+ * Mark a depot at the cell of a tile in a depot distance field.
+ * @param field The field.
+ * @param tile The tile of the depot.
+ */
+static void AddDepotDistanceSource(DepotDistanceField &field, TileIndex tile)
+{
+	if (field.distance.empty()) field.distance.assign((MapSizeX() >> DEPOT_FIELD_CELL_BITS) * (MapSizeY() >> DEPOT_FIELD_CELL_BITS), UINT16_MAX);
+
+	uint cell = GetDepotFieldCell(tile);
+	if (field.distance[cell] == 0) return;
+
+	field.distance[cell] = 0;
+	std::vector<uint> queue(1, cell);
+	SpreadDepotDistance(field, queue);
+}
+
+/**
+ * Get the depot distance field of a company, building it when needed.
+ * @param owner The company.
+ * @param type The transport type of the depots.
+ * @return The field.
+ */
+static const DepotDistanceField &GetDepotDistanceField(Owner owner, TransportType type)
+{
+	assert(owner < MAX_COMPANIES && type <= TRANSPORT_WATER);
+	DepotDistanceField &field = _depot_distance_fields[owner][type];
+	if (field.valid) return field;
+
+	field.depots.clear();
+	field.distance.clear();
+
+	const Depot *d;
+	FOR_ALL_DEPOTS(d) {
+		if (!IsDepotTypeTile(d->xy, type) || !IsTileOwner(d->xy, owner)) continue;
+		field.depots.push_back(d->index);
+		AddDepotDistanceSource(field, d->xy);
+	}
+
+	field.valid = true;
+	return field;
+}
+
+/**
+ * Mark all depot distance fields as outdated, so they get rebuilt when needed.
+ */
+void InvalidateDepotDistanceFields()
+{
+	for (auto &fields : _depot_distance_fields) {
+		for (DepotDistanceField &field : fields) field.valid = false;
+	}
+}
+
+/**
+ * Add a newly built depot to the depot distance field of its owner.
+ * @param tile The tile of the depot.
+ */
+void AddDepotToDistanceField(TileIndex tile)
+{
+	Owner owner = GetTileOwner(tile);
+	if (owner >= MAX_COMPANIES) return;
+
+	TransportType type;
+	if (IsRailDepotTile(tile)) {
+		type = TRANSPORT_RAIL;
+	} else if (IsRoadDepotTile(tile)) {
+		type = TRANSPORT_ROAD;
+	} else {
+		assert(IsShipDepotTile(tile));
+		type = TRANSPORT_WATER;
+	}
+
+	DepotDistanceField &field = _depot_distance_fields[owner][type];
+	if (!field.valid) return;
+
+	DepotID index = GetDepotIndex(tile);
+	field.depots.insert(std::lower_bound(field.depots.begin(), field.depots.end(), index), index);
+	AddDepotDistanceSource(field, tile);
+}
+
+/**
+ * Get a lower bound of the Manhattan distance from a tile to the nearest depot of a company.
+ * @param tile The tile.
+ * @param owner The company.
+ * @param type The transport type of the depots.
+ * @return The lower bound in tiles, or UINT_MAX when the company has no such depots.
+ */
+uint GetDepotDistanceLowerBound(TileIndex tile, Owner owner, TransportType type)
+{
+	if (owner >= MAX_COMPANIES) return 0;
+
+	const DepotDistanceField &field = GetDepotDistanceField(owner, type);
+	if (field.depots.empty()) return UINT_MAX;
+
+	/* Both coordinates of a tile in a cell that is 'distance' cells away from a
+	 * depot may be at the border of their cells nearest to the depot. */
+	uint distance = field.distance[GetDepotFieldCell(tile)];
+	if (distance <= 1) return distance;
+	return (distance - 2) * DEPOT_FIELD_CELL_SIZE + 2;
+}
+
+/**
+ * Get the depots of a company.
+ * @param owner The company.
+ * @param type The transport type of the depots.
+ * @return The depots, sorted by index.
+ */
+const std::vector<DepotID> &GetCompanyDepots(Owner owner, TransportType type)
+{
+	return GetDepotDistanceField(owner, type).depots;
+}
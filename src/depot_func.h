@@ -14,11 +14,20 @@
 
 #include "vehicle_type.h"
 #include "slope_func.h"
+#include "company_type.h"
+#include "depot_type.h"
+#include "transport_type.h"
+#include <vector>
 
 void ShowDepotWindow(TileIndex tile, VehicleType type);
 
 void DeleteDepotHighlightOfVehicle(const Vehicle *v);
 
+void InvalidateDepotDistanceFields();
+void AddDepotToDistanceField(TileIndex tile);
+uint GetDepotDistanceLowerBound(TileIndex tile, Owner owner, TransportType type);
+const std::vector<DepotID> &GetCompanyDepots(Owner owner, TransportType type);
+
 /**
  * Find out if the slope of the tile is suitable to build a depot of given direction
  * @param direction The direction in which the depot's exit points
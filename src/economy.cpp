@@ -50,6 +50,9 @@
 #include "goal_base.h"
 #include "story_base.h"
 #include "linkgraph/refresh.h"
+#include "depot_func.h"
+#include "signal_func.h"
+#include "pathfinder/yapf/yapf_cache.h"
 
 #include "table/strings.h"
 #include "table/pricebase.h"
@@ -489,6 +492,10 @@ void ChangeOwnershipOfCompanyItems(Owner old_owner, Owner new_owner)
 		do {
 			ChangeTileOwner(tile, old_owner, new_owner);
 		} while (++tile != MapSize());
+		InvalidateDepotDistanceFields();
+		InvalidateSignalSegmentCache();
+		/* The track of other companies ends the segments of the path finder; all may have changed. */
+		YapfNotifyTrackLayoutChange(INVALID_TILE, INVALID_TRACK);
 
 		if (new_owner != INVALID_OWNER) {
 			/* Update all signals because there can be new segment that was owned by two companies
@@ -187,6 +187,7 @@ namespace {
 		PerformanceData(1),                     // PFE_ACC_GL_AIRCRAFT
 		PerformanceData(1),                     // PFE_GL_LANDSCAPE
 		PerformanceData(1),                     // PFE_GL_LINKGRAPH
+		PerformanceData(1),                     // PFE_GL_AUTOSAVE
 		PerformanceData(GL_RATE),               // PFE_DRAWING
 		PerformanceData(1),                     // PFE_ACC_DRAWWORLD
 		PerformanceData(60.0),                  // PFE_VIDEO
@@ -334,6 +335,7 @@ static const PerformanceElement DISPLAY_ORDER_PFE[PFE_MAX] = {
 	PFE_AI13,
 	PFE_AI14,
 	PFE_GL_LINKGRAPH,
+	PFE_GL_AUTOSAVE,
 	PFE_DRAWING,
 	PFE_DRAWWORLD,
 	PFE_VIDEO,
@@ -1033,6 +1035,7 @@ void ConPrintFramerate()
 		"  GL aircraft ticks",
 		"  GL landscape ticks",
 		"  GL link graph delays",
+		"  GL autosave delays",
 		"Drawing",
 		"  Viewport drawing",
 		"Video output",
@@ -56,6 +56,7 @@ enum PerformanceElement {
 	PFE_GL_AIRCRAFT,   ///< Time spent processing aircraft
 	PFE_GL_LANDSCAPE,  ///< Time spent processing other world features
 	PFE_GL_LINKGRAPH,  ///< Time spent waiting for link graph background jobs
+	PFE_GL_AUTOSAVE,   ///< Time the game loop is stalled by autosaving
 	PFE_DRAWING,       ///< Speed of drawing world and GUI.
 	PFE_DRAWWORLD,     ///< Time spent drawing world viewports in GUI
 	PFE_VIDEO,         ///< Speed of painting drawn video buffer.
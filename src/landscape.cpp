@@ -33,6 +33,9 @@
 #include "pathfinder/npf/aystar.h"
 #include "saveload/saveload.h"
 #include "framerate_type.h"
+#include "console_func.h"
+#include "core/backup_type.hpp"
+#include <chrono>
 #include <list>
 #include <set>
 
@@ -798,23 +801,43 @@ CommandCost CmdClearArea(TileIndex tile, DoCommandFlag flags, uint32 p1, uint32
 TileIndex _cur_tileloop_tile;
 
 /**
- * Gradually iterate over all tiles on the map, calling their TileLoopProcs once every 256 ticks.
+ * Get the next tile of the tile loop sequence.
+ * @param tile The current tile.
+ * @param feedback The feedback term of the LFSR for the current map size.
+ * @return The tile following \a tile.
  */
-void RunTileLoop()
+static inline TileIndex GetNextTileLoopTile(TileIndex tile, uint32 feedback)
 {
-	PerformanceAccumulator framerate(PFE_GL_LANDSCAPE);
-
-	/* The pseudorandom sequence of tiles is generated using a Galois linear feedback
-	 * shift register (LFSR). This allows a deterministic pseudorandom ordering, but
-	 * still with minimal state and fast iteration. */
+	/* Get the next tile in sequence using a Galois LFSR. */
+	return (tile >> 1) ^ (-(int32)(tile & 1) & feedback);
+}
 
+/**
+ * Get the feedback term of the LFSR of the tile loop for the current map size.
+ * @return The feedback term.
+ */
+static uint32 GetTileLoopFeedback()
+{
 	/* Maximal length LFSR feedback terms, from 12-bit (for 64x64 maps) to 24-bit (for 4096x4096 maps).
 	 * Extracted from http://www.ece.cmu.edu/~koopman/lfsr/ */
 	static const uint32 feedbacks[] = {
 		0xD8F, 0x1296, 0x2496, 0x4357, 0x8679, 0x1030E, 0x206CD, 0x403FE, 0x807B8, 0x1004B2, 0x2006A8, 0x4004B2, 0x800B87
 	};
 	assert_compile(lengthof(feedbacks) == 2 * MAX_MAP_SIZE_BITS - 2 * MIN_MAP_SIZE_BITS + 1);
-	const uint32 feedback = feedbacks[MapLogX() + MapLogY() - 2 * MIN_MAP_SIZE_BITS];
+	return feedbacks[MapLogX() + MapLogY() - 2 * MIN_MAP_SIZE_BITS];
+}
+
+/**
+ * Gradually iterate over all tiles on the map, calling their TileLoopProcs once every 256 ticks.
+ */
+void RunTileLoop()
+{
+	PerformanceAccumulator framerate(PFE_GL_LANDSCAPE);
+
+	/* The pseudorandom sequence of tiles is generated using a Galois linear feedback
+	 * shift register (LFSR). This allows a deterministic pseudorandom ordering, but
+	 * still with minimal state and fast iteration. */
+	const uint32 feedback = GetTileLoopFeedback();
 
 	/* We update every tile every 256 ticks, so divide the map size by 2^8 = 256 */
 	uint count = 1 << (MapLogX() + MapLogY() - 8);
@@ -831,14 +854,73 @@ void RunTileLoop()
 
 	while (count--) {
 		_tile_type_procs[GetTileType(tile)]->tile_loop_proc(tile);
-
-		/* Get the next tile in sequence using a Galois LFSR. */
-		tile = (tile >> 1) ^ (-(int32)(tile & 1) & feedback);
+		tile = GetNextTileLoopTile(tile, feedback);
 	}
 
 	_cur_tileloop_tile = tile;
 }
 
+/**
+ * Time the map accesses of the tile loop, the smallmap and terraforming on
+ * the current map, without changing it, to compare map storage backends.
+ * - The tile loop workload walks all tiles in the order of the tile loop
+ *   and reads the tile type, the slope and
+ *   the fields most tile loop procs look at first.
+ * - The smallmap workload walks all tiles row by row and reads what the
+ *   contour, owner and routes views read: the type, height and owner.
+ * - The terraform workload tests raising 16x16 areas spread over the map,
+ *   which runs the full terraform checks without executing them.
+ * @param rounds Number of times each workload is run.
+ */
+void BenchmarkMap(uint rounds)
+{
+	const uint32 feedback = GetTileLoopFeedback();
+	uint32 checksum = 0;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (uint r = 0; r < rounds; r++) {
+		TileIndex tile = 1;
+		do {
+			int z;
+			Slope slope = GetTileSlope(tile, &z);
+			checksum += GetTileType(tile) + slope + z + _m[tile].m3 + _m[tile].m5;
+			tile = GetNextTileLoopTile(tile, feedback);
+		} while (tile != 1);
+	}
+	auto tile_loop_end = std::chrono::high_resolution_clock::now();
+
+	for (uint r = 0; r < rounds; r++) {
+		for (TileIndex tile = 0; tile < MapSize(); tile++) {
+			TileType type = GetTileType(tile);
+			checksum += type + TileHeight(tile);
+			if (type != MP_HOUSE && type != MP_INDUSTRY && type != MP_VOID) checksum += GetTileOwner(tile);
+		}
+	}
+	auto smallmap_end = std::chrono::high_resolution_clock::now();
+
+	uint terraformed = 0;
+	{
+		Backup<CompanyID> cur_company(_current_company, OWNER_NONE, FILE_LINE);
+		for (uint r = 0; r < rounds; r++) {
+			for (uint y = 1; y + 16 < MapMaxY(); y += 64) {
+				for (uint x = 1; x + 16 < MapMaxX(); x += 64) {
+					CommandCost ret = DoCommand(TileXY(x + 15, y + 15), TileXY(x, y), LM_RAISE << 1, DC_NONE, CMD_LEVEL_LAND);
+					if (ret.Succeeded()) terraformed++;
+				}
+			}
+		}
+		cur_company.Restore();
+	}
+	auto terraform_end = std::chrono::high_resolution_clock::now();
+
+	auto us = [](std::chrono::high_resolution_clock::time_point from, std::chrono::high_resolution_clock::time_point to) -> double {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count() / 1000.0;
+	};
+	IConsolePrintF(CC_DEFAULT, "Map of %ux%u tiles, %u rounds, checksum %08x", MapSizeX(), MapSizeY(), rounds, checksum);
+	IConsolePrintF(CC_DEFAULT, "Tile loop: %.0f us, smallmap: %.0f us, terraform: %.0f us (%u areas) per round",
+		us(start, tile_loop_end) / rounds, us(tile_loop_end, smallmap_end) / rounds, us(smallmap_end, terraform_end) / rounds, terraformed / rounds);
+}
+
 void InitializeLandscape()
 {
 	for (uint y = _settings_game.construction.freeform_edges ? 1 : 0; y < MapMaxY(); y++) {
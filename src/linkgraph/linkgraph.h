@@ -14,7 +14,6 @@
 
 #include "../core/pool_type.hpp"
 #include "../core/smallmap_type.hpp"
-#include "../core/smallmatrix_type.hpp"
 #include "../station_base.h"
 #include "../cargotype.h"
 #include "../date_func.h"
@@ -40,6 +39,22 @@ extern LinkGraphPool _link_graph_pool;
 class LinkGraph : public LinkGraphPool::PoolItem<&_link_graph_pool> {
 public:
 
+	/**
+	 * An edge in the link graph. Corresponds to a link between two stations.
+	 * Only edges with capacity are stored; they are kept in their source node.
+	 */
+	struct BaseEdge {
+		uint capacity;                 ///< Capacity of the link.
+		uint usage;                    ///< Usage of the link.
+		Date last_unrestricted_update; ///< When the unrestricted part of the link was last updated.
+		Date last_restricted_update;   ///< When the restricted part of the link was last updated.
+		NodeID dest_node;              ///< Destination of the edge.
+		void Init(NodeID dest_node = INVALID_NODE);
+	};
+
+	/** Outgoing edges of a node, the most recently added one first. */
+	typedef std::vector<BaseEdge> EdgeVector;
+
 	/**
 	 * Node of the link graph. contains all relevant information from the associated
 	 * station. It's copied so that the link graph job can work on its own data set
@@ -51,24 +66,10 @@ public:
 		StationID station;       ///< Station ID.
 		TileIndex xy;            ///< Location of the station referred to by the node.
 		Date last_update;        ///< When the supply was last updated.
+		EdgeVector edges;        ///< Outgoing edges, the most recently added one first.
 		void Init(TileIndex xy = INVALID_TILE, StationID st = INVALID_STATION, uint demand = 0);
 	};
 
-	/**
-	 * An edge in the link graph. Corresponds to a link between two stations or at
-	 * least the distance between them. Edges from one node to itself contain the
-	 * ID of the opposite Node of the first active edge (i.e. not just distance) in
-	 * the column as next_edge.
-	 */
-	struct BaseEdge {
-		uint capacity;                 ///< Capacity of the link.
-		uint usage;                    ///< Usage of the link.
-		Date last_unrestricted_update; ///< When the unrestricted part of the link was last updated.
-		Date last_restricted_update;   ///< When the restricted part of the link was last updated.
-		NodeID next_edge;              ///< Destination of next valid edge starting at the same source node.
-		void Init();
-	};
-
 	/**
 	 * Wrapper for an edge (const or not) allowing retrieval, but no modification.
 	 * @tparam Tedge Actual edge class, may be "const BaseEdge" or just "BaseEdge".
@@ -126,19 +127,29 @@ public:
 	class NodeWrapper {
 	protected:
 		Tnode &node;  ///< Node being wrapped.
-		Tedge *edges; ///< Outgoing edges for wrapped node.
 		NodeID index; ///< ID of wrapped node.
 
+		/**
+		 * Find the outgoing edge to another node.
+		 * @param to ID of end node of edge.
+		 * @return The edge or nullptr if the nodes aren't connected.
+		 */
+		Tedge *FindEdge(NodeID to) const
+		{
+			for (Tedge &edge : this->node.edges) {
+				if (edge.dest_node == to) return &edge;
+			}
+			return nullptr;
+		}
+
 	public:
 
 		/**
 		 * Wrap a node.
 		 * @param node Node to be wrapped.
-		 * @param edges Outgoing edges for node to be wrapped.
 		 * @param index ID of node to be wrapped.
 		 */
-		NodeWrapper(Tnode &node, Tedge *edges, NodeID index) : node(node),
-			edges(edges), index(index) {}
+		NodeWrapper(Tnode &node, NodeID index) : node(node), index(index) {}
 
 		/**
 		 * Get supply of wrapped node.
@@ -172,9 +183,7 @@ public:
 	};
 
 	/**
-	 * Base class for iterating across outgoing edges of a node. Only the real
-	 * edges (those with capacity) are iterated. The ones with only distance
-	 * information are skipped.
+	 * Base class for iterating across outgoing edges of a node.
 	 * @tparam Tedge Actual edge class. May be "BaseEdge" or "const BaseEdge".
 	 * @tparam Titer Actual iterator class.
 	 */
@@ -182,7 +191,7 @@ public:
 	class BaseEdgeIterator {
 	protected:
 		Tedge *base;    ///< Array of edges being iterated.
-		NodeID current; ///< Current offset in edges array.
+		size_t current; ///< Current offset in edges array.
 
 		/**
 		 * A "fake" pointer to enable operator-> on temporaries. As the objects
@@ -210,11 +219,11 @@ public:
 		/**
 		 * Constructor.
 		 * @param base Array of edges to be iterated.
-		 * @param current ID of current node (to locate the first edge).
+		 * @param current Offset of the current edge in the array.
 		 */
-		BaseEdgeIterator (Tedge *base, NodeID current) :
+		BaseEdgeIterator (Tedge *base, size_t current) :
 			base(base),
-			current(current == INVALID_NODE ? current : base[current].next_edge)
+			current(current)
 		{}
 
 		/**
@@ -223,7 +232,7 @@ public:
 		 */
 		Titer &operator++()
 		{
-			this->current = this->base[this->current].next_edge;
+			this->current++;
 			return static_cast<Titer &>(*this);
 		}
 
@@ -234,7 +243,7 @@ public:
 		Titer operator++(int)
 		{
 			Titer ret(static_cast<Titer &>(*this));
-			this->current = this->base[this->current].next_edge;
+			this->current++;
 			return ret;
 		}
 
@@ -243,7 +252,7 @@ public:
 		 * child class.
 		 * @tparam Tother Class of other iterator.
 		 * @param other Instance of other iterator.
-		 * @return If the iterators have the same edge array and current node.
+		 * @return If the iterators have the same edge array and current edge.
 		 */
 		template<class Tother>
 		bool operator==(const Tother &other)
@@ -256,7 +265,7 @@ public:
 		 * may be of a child class.
 		 * @tparam Tother Class of other iterator.
 		 * @param other Instance of other iterator.
-		 * @return If either the edge arrays or the current nodes differ.
+		 * @return If either the edge arrays or the current edges differ.
 		 */
 		template<class Tother>
 		bool operator!=(const Tother &other)
@@ -270,7 +279,7 @@ public:
 		 */
 		SmallPair<NodeID, Tedge_wrapper> operator*() const
 		{
-			return SmallPair<NodeID, Tedge_wrapper>(this->current, Tedge_wrapper(this->base[this->current]));
+			return SmallPair<NodeID, Tedge_wrapper>(this->base[this->current].dest_node, Tedge_wrapper(this->base[this->current]));
 		}
 
 		/**
@@ -311,9 +320,9 @@ public:
 		/**
 		 * Constructor.
 		 * @param edges Array of edges to be iterated over.
-		 * @param current ID of current edge's end node.
+		 * @param current Offset of the current edge in the array.
 		 */
-		ConstEdgeIterator(const BaseEdge *edges, NodeID current) :
+		ConstEdgeIterator(const BaseEdge *edges, size_t current) :
 			BaseEdgeIterator<const BaseEdge, ConstEdge, ConstEdgeIterator>(edges, current) {}
 	};
 
@@ -326,9 +335,9 @@ public:
 		/**
 		 * Constructor.
 		 * @param edges Array of edges to be iterated over.
-		 * @param current ID of current edge's end node.
+		 * @param current Offset of the current edge in the array.
 		 */
-		EdgeIterator(BaseEdge *edges, NodeID current) :
+		EdgeIterator(BaseEdge *edges, size_t current) :
 			BaseEdgeIterator<BaseEdge, Edge, EdgeIterator>(edges, current) {}
 	};
 
@@ -344,28 +353,32 @@ public:
 		 * @param node ID of the node.
 		 */
 		ConstNode(const LinkGraph *lg, NodeID node) :
-			NodeWrapper<const BaseNode, const BaseEdge>(lg->nodes[node], lg->edges[node], node)
+			NodeWrapper<const BaseNode, const BaseEdge>(lg->nodes[node], node)
 		{}
 
 		/**
 		 * Get a ConstEdge. This is not a reference as the wrapper objects are
 		 * not actually persistent.
 		 * @param to ID of end node of edge.
-		 * @return Constant edge wrapper.
+		 * @return Constant edge wrapper; an edge without capacity if the nodes aren't connected.
 		 */
-		ConstEdge operator[](NodeID to) const { return ConstEdge(this->edges[to]); }
+		ConstEdge operator[](NodeID to) const
+		{
+			const BaseEdge *edge = this->FindEdge(to);
+			return ConstEdge(edge != nullptr ? *edge : LinkGraph::empty_edge);
+		}
 
 		/**
 		 * Get an iterator pointing to the start of the edges array.
 		 * @return Constant edge iterator.
 		 */
-		ConstEdgeIterator Begin() const { return ConstEdgeIterator(this->edges, this->index); }
+		ConstEdgeIterator Begin() const { return ConstEdgeIterator(this->node.edges.data(), 0); }
 
 		/**
 		 * Get an iterator pointing beyond the end of the edges array.
 		 * @return Constant edge iterator.
 		 */
-		ConstEdgeIterator End() const { return ConstEdgeIterator(this->edges, INVALID_NODE); }
+		ConstEdgeIterator End() const { return ConstEdgeIterator(this->node.edges.data(), this->node.edges.size()); }
 	};
 
 	/**
@@ -379,28 +392,33 @@ public:
 		 * @param node ID of the node.
 		 */
 		Node(LinkGraph *lg, NodeID node) :
-			NodeWrapper<BaseNode, BaseEdge>(lg->nodes[node], lg->edges[node], node)
+			NodeWrapper<BaseNode, BaseEdge>(lg->nodes[node], node)
 		{}
 
 		/**
 		 * Get an Edge. This is not a reference as the wrapper objects are not
 		 * actually persistent.
-		 * @param to ID of end node of edge.
+		 * @param to ID of end node of edge; the edge has to exist.
 		 * @return Edge wrapper.
 		 */
-		Edge operator[](NodeID to) { return Edge(this->edges[to]); }
+		Edge operator[](NodeID to)
+		{
+			BaseEdge *edge = this->FindEdge(to);
+			assert(edge != nullptr);
+			return Edge(*edge);
+		}
 
 		/**
 		 * Get an iterator pointing to the start of the edges array.
 		 * @return Edge iterator.
 		 */
-		EdgeIterator Begin() { return EdgeIterator(this->edges, this->index); }
+		EdgeIterator Begin() { return EdgeIterator(this->node.edges.data(), 0); }
 
 		/**
 		 * Get an iterator pointing beyond the end of the edges array.
 		 * @return Constant edge iterator.
 		 */
-		EdgeIterator End() { return EdgeIterator(this->edges, INVALID_NODE); }
+		EdgeIterator End() { return EdgeIterator(this->node.edges.data(), this->node.edges.size()); }
 
 		/**
 		 * Update the node's supply and set last_update to the current date.
@@ -436,7 +454,8 @@ public:
 	};
 
 	typedef std::vector<BaseNode> NodeVector;
-	typedef SmallMatrix<BaseEdge> EdgeMatrix;
+
+	static const BaseEdge empty_edge; ///< Edge without capacity, standing in for the link between unconnected nodes.
 
 	/** Minimum effective distance for timeout calculation. */
 	static const uint MIN_TIMEOUT_DISTANCE = 32;
@@ -526,14 +545,16 @@ public:
 protected:
 	friend class LinkGraph::ConstNode;
 	friend class LinkGraph::Node;
+	friend class LinkGraphJob;
+	friend class LinkGraphSchedule;
 	friend const SaveLoad *GetLinkGraphDesc();
 	friend const SaveLoad *GetLinkGraphJobDesc();
-	friend void SaveLoad_LinkGraph(LinkGraph &lg);
+	friend void Save_LinkGraph(LinkGraph &lg);
+	friend void Load_LinkGraph(LinkGraph &lg);
 
 	CargoID cargo;         ///< Cargo of this component's link graph.
 	Date last_compression; ///< Last time the capacities and supplies were compressed.
-	NodeVector nodes;      ///< Nodes in the component.
-	EdgeMatrix edges;      ///< Edges in the component.
+	NodeVector nodes;      ///< Nodes in the component, each with its outgoing edges.
 };
 
 #define FOR_ALL_LINK_GRAPHS(var) FOR_ALL_ITEMS_FROM(LinkGraph, link_graph_index, var, 0)
@@ -115,7 +115,7 @@ LinkGraphJob::~LinkGraphJob()
 			continue;
 		}
 
-		LinkGraph *lg = LinkGraph::Get(ge.link_graph);
+		const LinkGraph *lg = LinkGraph::Get(ge.link_graph);
 		FlowStatMap &flows = from.Flows();
 
 		for (EdgeIterator it(from.Begin()); it != from.End(); ++it) {
@@ -176,14 +176,21 @@ void LinkGraphJob::Init()
 {
 	uint size = this->Size();
 	this->nodes.resize(size);
-	this->edges.Resize(size, size);
+	this->first_edges.resize(size + 1);
+	this->demands.Resize(size, size);
+	size_t num_edges = 0;
 	for (uint i = 0; i < size; ++i) {
 		this->nodes[i].Init(this->link_graph[i].Supply());
-		EdgeAnnotation *node_edges = this->edges[i];
+		this->first_edges[i] = num_edges;
+		num_edges += this->link_graph.nodes[i].edges.size();
+		DemandAnnotation *node_demands = this->demands[i];
 		for (uint j = 0; j < size; ++j) {
-			node_edges[j].Init();
+			node_demands[j].Init();
 		}
 	}
+	this->first_edges[size] = num_edges;
+	this->edges.resize(num_edges);
+	for (EdgeAnnotation &edge : this->edges) edge.Init();
 }
 
 /**
@@ -191,8 +198,15 @@ void LinkGraphJob::Init()
  */
 void LinkGraphJob::EdgeAnnotation::Init()
 {
-	this->demand = 0;
 	this->flow = 0;
+}
+
+/**
+ * Initialize the demand between two nodes of a linkgraph job.
+ */
+void LinkGraphJob::DemandAnnotation::Init()
+{
+	this->demand = 0;
 	this->unsatisfied_demand = 0;
 }
 
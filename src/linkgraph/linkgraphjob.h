@@ -13,6 +13,7 @@
 #define LINKGRAPHJOB_H
 
 #include "../thread.h"
+#include "../core/smallmatrix_type.hpp"
 #include "linkgraph.h"
 #include <list>
 
@@ -34,12 +35,19 @@ private:
 	 * Annotation for a link graph edge.
 	 */
 	struct EdgeAnnotation {
-		uint demand;             ///< Transport demand between the nodes.
-		uint unsatisfied_demand; ///< Demand over this edge that hasn't been satisfied yet.
 		uint flow;               ///< Planned flow over this edge.
 		void Init();
 	};
 
+	/**
+	 * Annotation for a pair of nodes, whether they are connected or not.
+	 */
+	struct DemandAnnotation {
+		uint demand;             ///< Transport demand between the nodes.
+		uint unsatisfied_demand; ///< Demand between the nodes that hasn't been satisfied yet.
+		void Init();
+	};
+
 	/**
 	 * Annotation for a link graph node.
 	 */
@@ -51,7 +59,8 @@ private:
 	};
 
 	typedef std::vector<NodeAnnotation> NodeAnnotationVector;
-	typedef SmallMatrix<EdgeAnnotation> EdgeAnnotationMatrix;
+	typedef std::vector<EdgeAnnotation> EdgeAnnotationVector;
+	typedef SmallMatrix<DemandAnnotation> DemandAnnotationMatrix;
 
 	friend const SaveLoad *GetLinkGraphJobDesc();
 	friend class LinkGraphSchedule;
@@ -62,7 +71,9 @@ protected:
 	std::thread thread;               ///< Thread the job is running in or a default-constructed thread if it's running in the main thread.
 	Date join_date;                   ///< Date when the job is to be joined.
 	NodeAnnotationVector nodes;       ///< Extra node data necessary for link graph calculation.
-	EdgeAnnotationMatrix edges;       ///< Extra edge data necessary for link graph calculation.
+	EdgeAnnotationVector edges;       ///< Extra edge data necessary for link graph calculation, in the order of the nodes and their edges.
+	std::vector<size_t> first_edges;  ///< Offset of the first annotation of each node's edges in edges.
+	DemandAnnotationMatrix demands;   ///< Demands between all pairs of nodes.
 
 	void EraseFlows(NodeID from);
 	void JoinThread();
@@ -71,44 +82,52 @@ protected:
 public:
 
 	/**
-	 * A job edge. Wraps a link graph edge and an edge annotation. The
-	 * annotation can be modified, the edge is constant.
+	 * A job edge. Wraps a link graph edge, an edge annotation and the demand
+	 * annotation of its end points. The annotations can be modified, the edge
+	 * is constant. Unconnected nodes get an edge without capacity, which only
+	 * carries the demand between them.
 	 */
 	class Edge : public LinkGraph::ConstEdge {
 	private:
-		EdgeAnnotation &anno; ///< Annotation being wrapped.
+		EdgeAnnotation *anno;          ///< Annotation being wrapped, nullptr if the nodes aren't connected.
+		DemandAnnotation &demand_anno; ///< Demand annotation being wrapped.
 	public:
 		/**
 		 * Constructor.
 		 * @param edge Link graph edge to be wrapped.
-		 * @param anno Annotation to be wrapped.
+		 * @param anno Annotation to be wrapped, nullptr if the nodes aren't connected.
+		 * @param demand_anno Demand annotation to be wrapped.
 		 */
-		Edge(const LinkGraph::BaseEdge &edge, EdgeAnnotation &anno) :
-				LinkGraph::ConstEdge(edge), anno(anno) {}
+		Edge(const LinkGraph::BaseEdge &edge, EdgeAnnotation *anno, DemandAnnotation &demand_anno) :
+				LinkGraph::ConstEdge(edge), anno(anno), demand_anno(demand_anno) {}
 
 		/**
 		 * Get the transport demand between end the points of the edge.
 		 * @return Demand.
 		 */
-		uint Demand() const { return this->anno.demand; }
+		uint Demand() const { return this->demand_anno.demand; }
 
 		/**
 		 * Get the transport demand that hasn't been satisfied by flows, yet.
 		 * @return Unsatisfied demand.
 		 */
-		uint UnsatisfiedDemand() const { return this->anno.unsatisfied_demand; }
+		uint UnsatisfiedDemand() const { return this->demand_anno.unsatisfied_demand; }
 
 		/**
 		 * Get the total flow on the edge.
 		 * @return Flow.
 		 */
-		uint Flow() const { return this->anno.flow; }
+		uint Flow() const { return this->anno != nullptr ? this->anno->flow : 0; }
 
 		/**
 		 * Add some flow.
 		 * @param flow Flow to be added.
 		 */
-		void AddFlow(uint flow) { this->anno.flow += flow; }
+		void AddFlow(uint flow)
+		{
+			assert(this->anno != nullptr);
+			this->anno->flow += flow;
+		}
 
 		/**
 		 * Remove some flow.
@@ -116,8 +135,8 @@ public:
 		 */
 		void RemoveFlow(uint flow)
 		{
-			assert(flow <= this->anno.flow);
-			this->anno.flow -= flow;
+			assert(this->anno != nullptr && flow <= this->anno->flow);
+			this->anno->flow -= flow;
 		}
 
 		/**
@@ -126,8 +145,8 @@ public:
 		 */
 		void AddDemand(uint demand)
 		{
-			this->anno.demand += demand;
-			this->anno.unsatisfied_demand += demand;
+			this->demand_anno.demand += demand;
+			this->demand_anno.unsatisfied_demand += demand;
 		}
 
 		/**
@@ -136,8 +155,8 @@ public:
 		 */
 		void SatisfyDemand(uint demand)
 		{
-			assert(demand <= this->anno.unsatisfied_demand);
-			this->anno.unsatisfied_demand -= demand;
+			assert(demand <= this->demand_anno.unsatisfied_demand);
+			this->demand_anno.unsatisfied_demand -= demand;
 		}
 	};
 
@@ -145,17 +164,19 @@ public:
 	 * Iterator for job edges.
 	 */
 	class EdgeIterator : public LinkGraph::BaseEdgeIterator<const LinkGraph::BaseEdge, Edge, EdgeIterator> {
-		EdgeAnnotation *base_anno; ///< Array of annotations to be (indirectly) iterated.
+		EdgeAnnotation *base_anno;     ///< Array of annotations to be (indirectly) iterated.
+		DemandAnnotation *demand_anno; ///< Demand annotations of the source node, indexed by destination.
 	public:
 		/**
 		 * Constructor.
 		 * @param base Array of edges to be iterated.
 		 * @param base_anno Array of annotations to be iterated.
+		 * @param demand_anno Demand annotations of the edges' source node.
 		 * @param current Start offset of iteration.
 		 */
-		EdgeIterator(const LinkGraph::BaseEdge *base, EdgeAnnotation *base_anno, NodeID current) :
+		EdgeIterator(const LinkGraph::BaseEdge *base, EdgeAnnotation *base_anno, DemandAnnotation *demand_anno, size_t current) :
 				LinkGraph::BaseEdgeIterator<const LinkGraph::BaseEdge, Edge, EdgeIterator>(base, current),
-				base_anno(base_anno) {}
+				base_anno(base_anno), demand_anno(demand_anno) {}
 
 		/**
 		 * Dereference.
@@ -164,7 +185,8 @@ public:
 		 */
 		SmallPair<NodeID, Edge> operator*() const
 		{
-			return SmallPair<NodeID, Edge>(this->current, Edge(this->base[this->current], this->base_anno[this->current]));
+			const LinkGraph::BaseEdge &edge = this->base[this->current];
+			return SmallPair<NodeID, Edge>(edge.dest_node, Edge(edge, &this->base_anno[this->current], this->demand_anno[edge.dest_node]));
 		}
 
 		/**
@@ -183,8 +205,9 @@ public:
 	 */
 	class Node : public LinkGraph::ConstNode {
 	private:
-		NodeAnnotation &node_anno;  ///< Annotation being wrapped.
-		EdgeAnnotation *edge_annos; ///< Edge annotations belonging to this node.
+		NodeAnnotation &node_anno;      ///< Annotation being wrapped.
+		EdgeAnnotation *edge_annos;     ///< Edge annotations belonging to this node, in the order of its edges.
+		DemandAnnotation *demand_annos; ///< Demand annotations belonging to this node, indexed by destination.
 	public:
 
 		/**
@@ -194,30 +217,34 @@ public:
 		 */
 		Node (LinkGraphJob *lgj, NodeID node) :
 			LinkGraph::ConstNode(&lgj->link_graph, node),
-			node_anno(lgj->nodes[node]), edge_annos(lgj->edges[node])
+			node_anno(lgj->nodes[node]), edge_annos(lgj->edges.data() + lgj->first_edges[node]),
+			demand_annos(lgj->demands[node])
 		{}
 
 		/**
 		 * Retrieve an edge starting at this node. Mind that this returns an
 		 * object, not a reference.
 		 * @param to Remote end of the edge.
-		 * @return Edge between this node and "to".
+		 * @return Edge between this node and "to"; one without capacity if they aren't connected.
 		 */
-		Edge operator[](NodeID to) const { return Edge(this->edges[to], this->edge_annos[to]); }
+		Edge operator[](NodeID to) const
+		{
+			const LinkGraph::BaseEdge *edge = this->FindEdge(to);
+			if (edge == nullptr) return Edge(LinkGraph::empty_edge, nullptr, this->demand_annos[to]);
+			return Edge(*edge, this->edge_annos + (edge - this->node.edges.data()), this->demand_annos[to]);
+		}
 
 		/**
-		 * Iterator for the "begin" of the edge array. Only edges with capacity
-		 * are iterated. The others are skipped.
+		 * Iterator for the "begin" of the edge array.
 		 * @return Iterator pointing to the first edge.
 		 */
-		EdgeIterator Begin() const { return EdgeIterator(this->edges, this->edge_annos, index); }
+		EdgeIterator Begin() const { return EdgeIterator(this->node.edges.data(), this->edge_annos, this->demand_annos, 0); }
 
 		/**
-		 * Iterator for the "end" of the edge array. Only edges with capacity
-		 * are iterated. The others are skipped.
+		 * Iterator for the "end" of the edge array.
 		 * @return Iterator pointing beyond the last edge.
 		 */
-		EdgeIterator End() const { return EdgeIterator(this->edges, this->edge_annos, INVALID_NODE); }
+		EdgeIterator End() const { return EdgeIterator(this->node.edges.data(), this->edge_annos, this->demand_annos, this->node.edges.size()); }
 
 		/**
 		 * Get amount of supply that hasn't been delivered, yet.
@@ -16,6 +16,10 @@
 #include "mcf.h"
 #include "flowmapper.h"
 #include "../framerate_type.h"
+#include "../core/random_func.hpp"
+#include "../map_func.h"
+#include "../console_func.h"
+#include <chrono>
 
 #include "../safeguards.h"
 
@@ -79,6 +83,95 @@ void LinkGraphSchedule::JoinNext()
 	}
 }
 
+/**
+ * Time the calculation of a generated link graph component, to compare link
+ * graph storage layouts. The nodes are placed on a grid over the map and each
+ * node gets links to random nodes near it, in both directions. The graph is
+ * generated again for each run, so each run does the same work.
+ * @param num_nodes Number of nodes of the component.
+ * @param degree Number of links added from each node.
+ * @param runs Number of times the component is generated and calculated.
+ */
+/* static */ void LinkGraphSchedule::Benchmark(uint num_nodes, uint degree, uint runs)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	auto ms = [](Clock::time_point from, Clock::time_point to) -> double {
+		return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count() / 1000.0;
+	};
+
+	const uint width = max(1U, IntSqrt(num_nodes));
+	const uint spacing = max(1U, min(MapMaxX(), MapMaxY()) / (width + 2));
+	const uint NUM_PHASES = 5;
+	static const char * const phase_names[NUM_PHASES] = { "build", "copy", "init", "demands", "flows" };
+	double best[NUM_PHASES];
+	uint num_edges = 0;
+	uint32 checksum = 0;
+
+	for (uint run = 0; run < runs; run++) {
+		if (!LinkGraph::CanAllocateItem() || !LinkGraphJob::CanAllocateItem()) {
+			IConsoleError("There are too many link graphs to benchmark another one");
+			return;
+		}
+
+		Randomizer random;
+		random.SetSeed(num_nodes);
+		Clock::time_point times[NUM_PHASES + 1];
+
+		times[0] = Clock::now();
+		LinkGraph *lg = new LinkGraph(CT_PASSENGERS);
+		lg->Init(num_nodes);
+		for (NodeID node = 0; node < num_nodes; ++node) {
+			lg->nodes[node].station = node;
+			(*lg)[node].UpdateLocation(TileXY(1 + (node % width) * spacing, 1 + (node / width) * spacing));
+			(*lg)[node].SetDemand(1);
+			(*lg)[node].UpdateSupply(1 + random.Next(500));
+		}
+		for (NodeID from = 0; from < num_nodes; ++from) {
+			for (uint i = 0; i < degree; i++) {
+				int to = (int)from + ((int)random.Next(5) - 2) * (int)width + (int)random.Next(5) - 2;
+				if (to < 0 || to >= (int)num_nodes || to == (int)from) continue;
+				uint capacity = 100 + random.Next(1000);
+				uint usage = random.Next(capacity);
+				(*lg)[from].UpdateEdge((NodeID)to, capacity, usage, EUM_INCREASE | EUM_UNRESTRICTED);
+				(*lg)[to].UpdateEdge(from, capacity, usage, EUM_INCREASE | EUM_UNRESTRICTED);
+			}
+		}
+
+		times[1] = Clock::now();
+		LinkGraphJob *job = new LinkGraphJob(*lg);
+		times[2] = Clock::now();
+		for (uint i = 0; i < lengthof(instance.handlers); ++i) {
+			instance.handlers[i]->Run(*job);
+			if (i < 2) times[3 + i] = Clock::now();
+		}
+		times[NUM_PHASES] = Clock::now();
+
+		if (run == 0) {
+			for (NodeID node = 0; node < num_nodes; ++node) {
+				for (LinkGraph::EdgeIterator it = (*lg)[node].Begin(); it != (*lg)[node].End(); ++it) num_edges++;
+				for (const auto &flow : (*job)[node].Flows()) {
+					for (const auto &share : *flow.second.GetShares()) {
+						checksum = checksum * 31 + flow.first + share.first + (share.second << 16);
+					}
+				}
+			}
+		}
+		/* Without its link graph the job doesn't touch any stations when it is deleted. */
+		delete lg;
+		delete job;
+
+		for (uint i = 0; i < NUM_PHASES; i++) {
+			double phase = ms(times[i], times[i + 1]);
+			if (run == 0 || phase < best[i]) best[i] = phase;
+		}
+	}
+
+	IConsolePrintF(CC_DEFAULT, "Link graph of %u nodes and %u edges, flow checksum %08x, best of %u runs:", num_nodes, num_edges, checksum, runs);
+	for (uint i = 0; i < NUM_PHASES; i++) {
+		IConsolePrintF(CC_DEFAULT, "  %s: %.1f ms", phase_names[i], best[i]);
+	}
+}
+
 /**
  * Start all threads in the running list. This is only useful for save/load.
  * Usually threads are started when the job is created.
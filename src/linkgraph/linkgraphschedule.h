@@ -55,6 +55,7 @@ public:
 
 	static void Run(LinkGraphJob *job);
 	static void Clear();
+	static void Benchmark(uint num_nodes, uint degree, uint runs);
 
 	void SpawnNext();
 	void JoinNext();
@@ -2,6 +2,7 @@
 
 #include "../stdafx.h"
 #include "../core/math_func.hpp"
+#include "../worker_thread.h"
 #include "mcf.h"
 #include <set>
 
@@ -9,6 +10,13 @@
 
 typedef std::map<NodeID, Path *> PathViaMap;
 
+/**
+ * Number of sources whose paths are searched at once. The searches of a batch
+ * all see the flows as they were before the batch, so this has to be fixed to
+ * get the same results on any number of threads.
+ */
+static const uint MCF_SOURCE_BATCH = 32;
+
 /**
  * Distance-based annotation for use in the Dijkstra algorithm. This is close
  * to the original meaning of "annotation" in this context. Paths are rated
@@ -88,14 +96,15 @@ public:
 };
 
 /**
- * Iterator class for getting the edges in the order of their next_edge
- * members.
+ * Iterator class for getting the edges in the order they are stored in the
+ * link graph.
  */
 class GraphEdgeIterator {
 private:
 	LinkGraphJob &job; ///< Job being executed
 	EdgeIterator i;    ///< Iterator pointing to current edge.
 	EdgeIterator end;  ///< Iterator pointing beyond last edge.
+	EdgeIterator last; ///< Iterator pointing to the edge last returned by Next().
 
 public:
 
@@ -104,7 +113,7 @@ public:
 	 * @param job Job to iterate on.
 	 */
 	GraphEdgeIterator(LinkGraphJob &job) : job(job),
-		i(nullptr, nullptr, INVALID_NODE), end(nullptr, nullptr, INVALID_NODE)
+		i(nullptr, nullptr, nullptr, 0), end(nullptr, nullptr, nullptr, 0), last(nullptr, nullptr, nullptr, 0)
 	{}
 
 	/**
@@ -124,7 +133,20 @@ public:
 	 */
 	NodeID Next()
 	{
-		return this->i != this->end ? (this->i++)->first : INVALID_NODE;
+		if (this->i == this->end) return INVALID_NODE;
+		this->last = this->i++;
+		return this->last->first;
+	}
+
+	/**
+	 * Get the edge to the node last returned by Next(), without looking it up.
+	 * @param from Unused.
+	 * @param to Unused.
+	 * @return Edge last returned.
+	 */
+	Edge GetEdge(NodeID from, NodeID to) const
+	{
+		return this->last->second;
 	}
 };
 
@@ -187,6 +209,17 @@ public:
 		if (this->it == this->end) return INVALID_NODE;
 		return this->station_to_node[(this->it++)->second];
 	}
+
+	/**
+	 * Get the edge between two nodes.
+	 * @param from Source node of the edge.
+	 * @param to Destination node of the edge.
+	 * @return Edge between the nodes.
+	 */
+	Edge GetEdge(NodeID from, NodeID to) const
+	{
+		return this->job[from][to];
+	}
 };
 
 /**
@@ -277,7 +310,7 @@ void MultiCommodityFlow::Dijkstra(NodeID source_node, PathVector &paths)
 		iter.SetNode(source_node, from);
 		for (NodeID to = iter.Next(); to != INVALID_NODE; to = iter.Next()) {
 			if (to == from) continue; // Not a real edge but a consumption sign.
-			Edge edge = this->job[from][to];
+			Edge edge = iter.GetEdge(from, to);
 			uint capacity = edge.Capacity();
 			if (this->max_saturation != UINT_MAX) {
 				capacity *= this->max_saturation;
@@ -297,6 +330,25 @@ void MultiCommodityFlow::Dijkstra(NodeID source_node, PathVector &paths)
 	}
 }
 
+/**
+ * Search the paths of a batch of source nodes, spread over the worker threads.
+ * Each search only reads the job and writes its own paths.
+ * @tparam Tannotation Annotation to be used.
+ * @tparam Tedge_iterator Iterator to be used for getting outgoing edges.
+ * @param first First source node of the batch.
+ * @param last One past the last source node of the batch.
+ * @param paths Containers for the paths of each source, indexed by source - first.
+ */
+template<class Tannotation, class Tedge_iterator>
+void MultiCommodityFlow::FindPaths(NodeID first, NodeID last, std::vector<PathVector> &paths)
+{
+	RunOnWorkerThreads(last - first, 1, [this, first, &paths](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			this->Dijkstra<Tannotation, Tedge_iterator>((NodeID)(first + i), paths[i]);
+		}
+	});
+}
+
 /**
  * Clean up paths that lead nowhere and the root path.
  * @param source_id ID of the root node.
@@ -490,37 +542,54 @@ bool MCF1stPass::EliminateCycles()
  */
 MCF1stPass::MCF1stPass(LinkGraphJob &job) : MultiCommodityFlow(job)
 {
-	PathVector paths;
+	std::vector<PathVector> batch_paths(MCF_SOURCE_BATCH);
 	uint size = job.Size();
 	uint accuracy = job.Settings().accuracy;
 	bool more_loops;
 
 	do {
 		more_loops = false;
-		for (NodeID source = 0; source < size; ++source) {
+		for (NodeID first = 0; first < size; first += MCF_SOURCE_BATCH) {
+			NodeID last = min<uint>(size, first + MCF_SOURCE_BATCH);
 			/* First saturate the shortest paths. */
-			this->Dijkstra<DistanceAnnotation, GraphEdgeIterator>(source, paths);
-
-			for (NodeID dest = 0; dest < size; ++dest) {
-				Edge edge = job[source][dest];
-				if (edge.UnsatisfiedDemand() > 0) {
-					Path *path = paths[dest];
-					assert(path != nullptr);
-					/* Generally only allow paths that don't exceed the
-					 * available capacity. But if no demand has been assigned
-					 * yet, make an exception and allow any valid path *once*. */
-					if (path->GetFreeCapacity() > 0 && this->PushFlow(edge, path,
-							accuracy, this->max_saturation) > 0) {
-						/* If a path has been found there is a chance we can
-						 * find more. */
-						more_loops = more_loops || (edge.UnsatisfiedDemand() > 0);
-					} else if (edge.UnsatisfiedDemand() == edge.Demand() &&
-							path->GetFreeCapacity() > INT_MIN) {
-						this->PushFlow(edge, path, accuracy, UINT_MAX);
+			this->FindPaths<DistanceAnnotation, GraphEdgeIterator>(first, last, batch_paths);
+
+			/* Whether an earlier source of this batch has pushed flow since the paths were searched. */
+			bool stale = false;
+			for (NodeID source = first; source < last; ++source) {
+				PathVector &paths = batch_paths[source - first];
+				bool pushed = false;
+				for (NodeID dest = 0; dest < size; ++dest) {
+					Edge edge = job[source][dest];
+					if (edge.UnsatisfiedDemand() > 0) {
+						Path *path = paths[dest];
+						assert(path != nullptr);
+						/* Generally only allow paths that don't exceed the
+						 * available capacity. But if no demand has been assigned
+						 * yet, make an exception and allow any valid path *once*. */
+						if (path->GetFreeCapacity() > 0 && this->PushFlow(edge, path,
+								accuracy, this->max_saturation) > 0) {
+							/* If a path has been found there is a chance we can
+							 * find more. */
+							more_loops = more_loops || (edge.UnsatisfiedDemand() > 0);
+							pushed = true;
+						} else if (edge.UnsatisfiedDemand() == edge.Demand() &&
+								path->GetFreeCapacity() > INT_MIN) {
+							if (stale) {
+								/* Another source of this batch may have taken the
+								 * capacity the path was found with. Search again
+								 * with the new flows before overloading anything. */
+								more_loops = true;
+							} else {
+								this->PushFlow(edge, path, accuracy, UINT_MAX);
+								pushed = true;
+							}
+						}
 					}
 				}
+				this->CleanupPaths(source, paths);
+				stale = stale || pushed;
 			}
-			this->CleanupPaths(source, paths);
 		}
 	} while (more_loops || this->EliminateCycles());
 }
@@ -533,23 +602,27 @@ MCF1stPass::MCF1stPass(LinkGraphJob &job) : MultiCommodityFlow(job)
 MCF2ndPass::MCF2ndPass(LinkGraphJob &job) : MultiCommodityFlow(job)
 {
 	this->max_saturation = UINT_MAX; // disable artificial cap on saturation
-	PathVector paths;
+	std::vector<PathVector> batch_paths(MCF_SOURCE_BATCH);
 	uint size = job.Size();
 	uint accuracy = job.Settings().accuracy;
 	bool demand_left = true;
 	while (demand_left) {
 		demand_left = false;
-		for (NodeID source = 0; source < size; ++source) {
-			this->Dijkstra<CapacityAnnotation, FlowEdgeIterator>(source, paths);
-			for (NodeID dest = 0; dest < size; ++dest) {
-				Edge edge = this->job[source][dest];
-				Path *path = paths[dest];
-				if (edge.UnsatisfiedDemand() > 0 && path->GetFreeCapacity() > INT_MIN) {
-					this->PushFlow(edge, path, accuracy, UINT_MAX);
-					if (edge.UnsatisfiedDemand() > 0) demand_left = true;
+		for (NodeID first = 0; first < size; first += MCF_SOURCE_BATCH) {
+			NodeID last = min<uint>(size, first + MCF_SOURCE_BATCH);
+			this->FindPaths<CapacityAnnotation, FlowEdgeIterator>(first, last, batch_paths);
+			for (NodeID source = first; source < last; ++source) {
+				PathVector &paths = batch_paths[source - first];
+				for (NodeID dest = 0; dest < size; ++dest) {
+					Edge edge = this->job[source][dest];
+					Path *path = paths[dest];
+					if (edge.UnsatisfiedDemand() > 0 && path->GetFreeCapacity() > INT_MIN) {
+						this->PushFlow(edge, path, accuracy, UINT_MAX);
+						if (edge.UnsatisfiedDemand() > 0) demand_left = true;
+					}
 				}
+				this->CleanupPaths(source, paths);
 			}
-			this->CleanupPaths(source, paths);
 		}
 	}
 }
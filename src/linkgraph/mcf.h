@@ -24,6 +24,9 @@ protected:
 	template<class Tannotation, class Tedge_iterator>
 	void Dijkstra(NodeID from, PathVector &paths);
 
+	template<class Tannotation, class Tedge_iterator>
+	void FindPaths(NodeID first, NodeID last, std::vector<PathVector> &paths);
+
 	uint PushFlow(Edge &edge, Path *path, uint accuracy, uint max_saturation);
 
 	void CleanupPaths(NodeID source, PathVector &paths);
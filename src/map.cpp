@@ -29,8 +29,24 @@ uint _map_size_y;    ///< Size of the map along the Y
 uint _map_size;      ///< The number of tiles on the map
 uint _map_tile_mask; ///< _map_size - 1 (to mask the mapsize)
 
+#ifdef WITH_MAP_PLANES
+TilePlanes _m;               ///< Planes with the fields of the tiles of the map
+TileExtendedPlanes _me;      ///< Planes with the extended fields of the tiles of the map
+
+/**
+ * Free a plane of the map and allocate it again with the new map size, cleared.
+ * @param plane The plane to reallocate.
+ */
+template <typename T>
+static void ReallocPlane(T *&plane)
+{
+	free(plane);
+	plane = CallocT<T>(_map_size);
+}
+#else
 Tile *_m = nullptr;          ///< Tiles of the map
 TileExtended *_me = nullptr; ///< Extended Tiles of the map
+#endif /* WITH_MAP_PLANES */
 
 
 /**
@@ -58,11 +74,26 @@ void AllocateMap(uint size_x, uint size_y)
 	_map_size = size_x * size_y;
 	_map_tile_mask = _map_size - 1;
 
+#ifdef WITH_MAP_PLANES
+	ReallocPlane(_m.type);
+	ReallocPlane(_m.height);
+	ReallocPlane(_m.m2);
+	ReallocPlane(_m.m1);
+	ReallocPlane(_m.m3);
+	ReallocPlane(_m.m4);
+	ReallocPlane(_m.m5);
+	ReallocPlane(_me.m6);
+	ReallocPlane(_me.m7);
+	ReallocPlane(_me.m8);
+#else
 	free(_m);
 	free(_me);
 
 	_m = CallocT<Tile>(_map_size);
 	_me = CallocT<TileExtended>(_map_size);
+#endif /* WITH_MAP_PLANES */
+
+	InvalidateTrainReservationCache(INVALID_TILE);
 }
 
 
@@ -27,6 +27,21 @@ extern uint _map_tile_mask;
 
 #define TILE_MASK(x) ((x) & _map_tile_mask)
 
+#ifdef WITH_MAP_PLANES
+/**
+ * The planes with the fields of the tiles.
+ *
+ * Indexing it gives a #TileRef, which is used just like a #Tile.
+ */
+extern TilePlanes _m;
+
+/**
+ * The planes with the extended fields of the tiles.
+ *
+ * Indexing it gives a #TileExtendedRef, which is used just like a #TileExtended.
+ */
+extern TileExtendedPlanes _me;
+#else
 /**
  * Pointer to the tile-array.
  *
@@ -42,6 +57,9 @@ extern Tile *_m;
  * of the map.
  */
 extern TileExtended *_me;
+#endif /* WITH_MAP_PLANES */
+
+void InvalidateTrainReservationCache(TileIndex tile);
 
 void AllocateMap(uint size_x, uint size_y);
 
@@ -151,6 +169,13 @@ static inline uint ScaleByMapSize1D(uint n)
  * the resulting tileindex of the start tile applied
  * with this saved difference.
  *
+ * @note This only works because tiles are stored row by row: a step in
+ *       X is always 1 and a step in Y is always MapSizeX(), wherever on
+ *       the map the start tile is. Code all over the game adds these
+ *       offsets directly, wraps with #TILE_MASK and loops over the map
+ *       with a plain tile++, so a tiled or Z-ordered layout of the tiles
+ *       would need all of those to be rewritten, not just TileXY().
+ *
  * @see TileDiffXY(int, int)
  */
 typedef int32 TileIndexDiff;
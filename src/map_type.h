@@ -38,6 +38,68 @@ struct TileExtended {
 	uint16 m8; ///< General purpose
 };
 
+#ifdef WITH_MAP_PLANES
+/** Reference to the fields of one tile in the planes of the map, so it can be used like a #Tile. */
+struct TileRef {
+	byte   &type;   ///< The type (bits 4..7), bridges (2..3), rainforest/desert (0..1)
+	byte   &height; ///< The height of the northern corner.
+	uint16 &m2;     ///< Primarily used for indices to towns, industries and stations
+	byte   &m1;     ///< Primarily used for ownership information
+	byte   &m3;     ///< General purpose
+	byte   &m4;     ///< General purpose
+	byte   &m5;     ///< General purpose
+};
+
+/** Reference to the fields of one tile in the extended planes of the map, so it can be used like a #TileExtended. */
+struct TileExtendedRef {
+	byte   &m6;     ///< General purpose
+	byte   &m7;     ///< Primarily used for newgrf support
+	uint16 &m8;     ///< General purpose
+};
+
+/**
+ * The fields of #Tile, each stored in its own array (plane) covering the
+ * whole map. Scans that only need one field, like heights or tile types,
+ * then only touch the memory of that field instead of whole tile records.
+ */
+struct TilePlanes {
+	byte   *type;   ///< Plane of Tile::type
+	byte   *height; ///< Plane of Tile::height
+	uint16 *m2;     ///< Plane of Tile::m2
+	byte   *m1;     ///< Plane of Tile::m1
+	byte   *m3;     ///< Plane of Tile::m3
+	byte   *m4;     ///< Plane of Tile::m4
+	byte   *m5;     ///< Plane of Tile::m5
+
+	/**
+	 * Get the fields of a tile.
+	 * @param tile The tile to get.
+	 * @return Reference to the fields of the tile.
+	 */
+	inline TileRef operator[](uint tile) const
+	{
+		return { this->type[tile], this->height[tile], this->m2[tile], this->m1[tile], this->m3[tile], this->m4[tile], this->m5[tile] };
+	}
+};
+
+/** The fields of #TileExtended, each stored in its own array (plane) covering the whole map. */
+struct TileExtendedPlanes {
+	byte   *m6;     ///< Plane of TileExtended::m6
+	byte   *m7;     ///< Plane of TileExtended::m7
+	uint16 *m8;     ///< Plane of TileExtended::m8
+
+	/**
+	 * Get the fields of a tile.
+	 * @param tile The tile to get.
+	 * @return Reference to the fields of the tile.
+	 */
+	inline TileExtendedRef operator[](uint tile) const
+	{
+		return { this->m6[tile], this->m7[tile], this->m8[tile] };
+	}
+};
+#endif /* WITH_MAP_PLANES */
+
 /**
  * An offset value between to tiles.
  *
@@ -31,6 +31,10 @@
 #include "station_kdtree.h"
 #include "town_kdtree.h"
 #include "viewport_kdtree.h"
+#include "depot_func.h"
+#include "station_func.h"
+#include "signal_func.h"
+#include "pathfinder/pf_benchmark.h"
 
 #include "safeguards.h"
 
@@ -106,6 +110,10 @@ void InitializeGame(uint size_x, uint size_y, bool reset_date, bool reset_settin
 	InitializeBuildingCounts();
 
 	InitializeNPF();
+	InvalidateDepotDistanceFields();
+	ResetCatchmentIndex();
+	InvalidateSignalSegmentCache();
+	ResetPfBenchmark();
 
 	InitializeCompanies();
 	AI::Initialize();
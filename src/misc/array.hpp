@@ -87,7 +87,7 @@ public:
 	/** indexed access (non-const) */
 	inline T& operator[](uint index)
 	{
-		const SubArray &s = data[index / B];
+		SubArray &s = data[index / B];
 		T &item = s[index % B];
 		return item;
 	}
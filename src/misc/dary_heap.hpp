@@ -0,0 +1,226 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file dary_heap.hpp Implicit d-ary heap with integer keys, for priority queues. */
+
+#ifndef DARY_HEAP_HPP
+#define DARY_HEAP_HPP
+
+#include "../core/alloc_func.hpp"
+#include "../core/math_func.hpp"
+
+/**
+ * Implicit d-ary heap as C++ template.
+ *  A carrier which keeps its items automatically holds the item with the
+ *  smallest key at the first position, like #CBinaryHeapT.
+ *
+ * @par
+ * Every item is stored together with its integer key in one contiguous
+ * array, so ordering the heap only compares the keys next to each other
+ * instead of following the item pointers. With four children per node the
+ * heap is half as deep as a binary heap and the children of a node share
+ * a cache line, which makes removing the smallest item cheaper.
+ *
+ * @par Usage information:
+ * The key of an item can be given when including it. Otherwise the item
+ * must provide GetCostEstimate(), which is used as key. The key of an item
+ * must not change while it is in the heap.
+ *
+ * @par
+ * The indices accepted and returned by this heap start at 1, like the
+ * ones of #CBinaryHeapT, so 0 means "not found".
+ *
+ * @tparam T Type of the items stored in the heap
+ * @tparam D Number of children of every node
+ */
+template <class T, uint D = 4>
+class CDaryHeapT {
+private:
+	/** An item of the heap with its key. */
+	struct Entry {
+		int key; ///< The key of the item.
+		T *item; ///< The item.
+	};
+
+	uint items;    ///< Number of items in the heap
+	uint capacity; ///< Maximum number of items the heap can hold without growing
+	Entry *data;   ///< The items, ordered as implicit tree starting at data[0]
+
+public:
+	/**
+	 * Create a d-ary heap.
+	 * @param initial_items The number of items to reserve memory for.
+	 */
+	explicit CDaryHeapT(uint initial_items)
+		: items(0)
+		, capacity(max<uint>(initial_items, 1))
+	{
+		this->data = MallocT<Entry>(this->capacity);
+	}
+
+	~CDaryHeapT()
+	{
+		free(this->data);
+		this->data = nullptr;
+	}
+
+protected:
+	/**
+	 * Move a gap upwards until an item with the given key fits in it.
+	 * @param gap The position of the gap.
+	 * @param key The key of the item for filling the gap.
+	 * @return The position where the item fits.
+	 */
+	inline uint SiftUp(uint gap, int key)
+	{
+		while (gap > 0) {
+			uint parent = (gap - 1) / D;
+			if (!(key < this->data[parent].key)) break;
+			this->data[gap] = this->data[parent];
+			gap = parent;
+		}
+		return gap;
+	}
+
+	/**
+	 * Move a gap downwards until an item with the given key fits in it.
+	 * @param gap The position of the gap.
+	 * @param key The key of the item for filling the gap.
+	 * @return The position where the item fits.
+	 */
+	inline uint SiftDown(uint gap, int key)
+	{
+		for (;;) {
+			uint first = gap * D + 1;
+			if (first >= this->items) break;
+
+			/* choose the smallest child */
+			uint last = min(first + D, this->items);
+			uint child = first;
+			for (uint i = first + 1; i < last; i++) {
+				if (this->data[i].key < this->data[child].key) child = i;
+			}
+			if (!(this->data[child].key < key)) break;
+
+			this->data[gap] = this->data[child];
+			gap = child;
+		}
+		return gap;
+	}
+
+public:
+	/**
+	 * Get the number of items stored in the priority queue.
+	 * @return The number of items in the queue.
+	 */
+	inline uint Length() const
+	{
+		return this->items;
+	}
+
+	/**
+	 * Test if the priority queue is empty.
+	 * @return True if empty.
+	 */
+	inline bool IsEmpty() const
+	{
+		return this->items == 0;
+	}
+
+	/**
+	 * Get the item with the smallest key.
+	 * @return The smallest item, or throw assert if empty.
+	 */
+	inline T *Begin()
+	{
+		assert(!this->IsEmpty());
+		return this->data[0].item;
+	}
+
+	/**
+	 * Insert new item into the priority queue, maintaining heap order.
+	 * @param new_item The pointer to the new item.
+	 * @param key The key of the new item.
+	 */
+	inline void Include(T *new_item, int key)
+	{
+		if (this->items == this->capacity) {
+			assert(this->capacity < UINT_MAX / 2);
+
+			this->capacity *= 2;
+			this->data = ReallocT<Entry>(this->data, this->capacity);
+		}
+
+		uint gap = this->SiftUp(this->items++, key);
+		this->data[gap].key = key;
+		this->data[gap].item = new_item;
+	}
+
+	/**
+	 * Insert new item into the priority queue, keyed by its cost estimate.
+	 * @param new_item The pointer to the new item.
+	 */
+	inline void Include(T *new_item)
+	{
+		this->Include(new_item, new_item->GetCostEstimate());
+	}
+
+	/**
+	 * Remove and return the item with the smallest key.
+	 * @return The pointer to the removed item.
+	 */
+	inline T *Shift()
+	{
+		T *first = this->Begin();
+		this->Remove(1);
+		return first;
+	}
+
+	/**
+	 * Remove the item at the given index from the priority queue.
+	 * @param index The position of the item in the heap, starting at 1.
+	 */
+	inline void Remove(uint index)
+	{
+		assert(index != 0 && index <= this->items);
+
+		Entry last = this->data[--this->items];
+		if (index > this->items) return;
+
+		/* Fill the gap at index with the last item, up or downwards. */
+		uint gap = this->SiftUp(index - 1, last.key);
+		gap = this->SiftDown(gap, last.key);
+		this->data[gap] = last;
+	}
+
+	/**
+	 * Search for an item in the priority queue.
+	 * Matching is done by comparing address of the item.
+	 * @param item The reference to the item.
+	 * @return The index of the item starting at 1, or zero if not found.
+	 */
+	inline uint FindIndex(const T &item) const
+	{
+		for (uint i = 0; i < this->items; i++) {
+			if (this->data[i].item == &item) return i + 1;
+		}
+		return 0;
+	}
+
+	/**
+	 * Make the priority queue empty.
+	 * All remaining items will remain untouched.
+	 */
+	inline void Clear()
+	{
+		this->items = 0;
+	}
+};
+
+#endif /* DARY_HEAP_HPP */
@@ -0,0 +1,179 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file node_arena.hpp Storage for the nodes of path searches, reused between searches. */
+
+#ifndef NODE_ARENA_HPP
+#define NODE_ARENA_HPP
+
+#include "../core/alloc_func.hpp"
+#include "str.hpp"
+#include <new>
+#include <vector>
+
+/**
+ * Growing array of items that never moves its items, for the nodes of path
+ * searches. The items are stored in blocks of \a B items. Blocks of arenas
+ * that are destroyed are kept per thread and handed to the next arena of the
+ * same type, so a path finder that is created for every search does not
+ * allocate memory anymore once the first searches have been done.
+ * Define PATHFINDER_NO_NODE_ARENA to allocate every item on its own instead,
+ * e.g. for comparing both.
+ *
+ * @tparam T Type of the items.
+ * @tparam B Number of items per block.
+ */
+template <class T, uint B = 256>
+class CNodeArenaT {
+protected:
+#ifdef PATHFINDER_NO_NODE_ARENA
+	std::vector<T *> blocks; ///< The items, each allocated on its own.
+#else
+	static const uint MAX_KEPT_BLOCKS = 64; ///< Maximum number of unused blocks a thread keeps.
+
+	/** Unused blocks of a thread. */
+	struct BlockPool {
+		std::vector<T *> blocks; ///< The unused blocks.
+		bool *destroyed;         ///< Set when the pool is destroyed.
+
+		BlockPool(bool *destroyed) : destroyed(destroyed) {}
+
+		~BlockPool()
+		{
+			for (T *block : this->blocks) free(block);
+			*this->destroyed = true;
+		}
+	};
+
+	/**
+	 * Get the unused blocks of the current thread. When the thread ends, or
+	 * the game exits, the pool may be destroyed before arenas of static
+	 * objects, e.g. the one of NPF, are destroyed.
+	 * @return The block pool, or \c nullptr when it has been destroyed already.
+	 */
+	static BlockPool *GetPool()
+	{
+		/* Trivially destructible, so it is still valid after the pool is destroyed. */
+		static thread_local bool destroyed = false;
+		if (destroyed) return nullptr;
+		static thread_local BlockPool pool(&destroyed);
+		return &pool;
+	}
+
+	std::vector<T *> blocks; ///< Blocks of items, all but the last one are full.
+#endif /* PATHFINDER_NO_NODE_ARENA */
+	uint items;              ///< Number of items.
+
+	/** Destroy all items, keeping the blocks. */
+	inline void DestroyItems()
+	{
+		for (uint i = 0; i < this->items; i++) (*this)[i].~T();
+#ifdef PATHFINDER_NO_NODE_ARENA
+		for (T *item : this->blocks) free(item);
+		this->blocks.clear();
+#endif /* PATHFINDER_NO_NODE_ARENA */
+		this->items = 0;
+	}
+
+public:
+	CNodeArenaT() : items(0) {}
+
+	~CNodeArenaT()
+	{
+		this->DestroyItems();
+
+#ifndef PATHFINDER_NO_NODE_ARENA
+		BlockPool *pool = GetPool();
+		for (T *block : this->blocks) {
+			if (pool != nullptr && pool->blocks.size() < MAX_KEPT_BLOCKS) {
+				pool->blocks.push_back(block);
+			} else {
+				free(block);
+			}
+		}
+#endif /* PATHFINDER_NO_NODE_ARENA */
+	}
+
+	/**
+	 * Destroy all items. The memory is kept for new items.
+	 */
+	inline void Clear()
+	{
+		this->DestroyItems();
+	}
+
+	/**
+	 * Get the number of items.
+	 * @return The number of items.
+	 */
+	inline uint Length() const
+	{
+		return this->items;
+	}
+
+	/**
+	 * Allocate and construct a new item.
+	 * @return The new item.
+	 */
+	inline T *AppendC()
+	{
+#ifdef PATHFINDER_NO_NODE_ARENA
+		this->blocks.push_back(MallocT<T>(1));
+#else
+		if (this->items == this->blocks.size() * B) {
+			BlockPool *pool = GetPool();
+			if (pool == nullptr || pool->blocks.empty()) {
+				this->blocks.push_back(MallocT<T>(B));
+			} else {
+				this->blocks.push_back(pool->blocks.back());
+				pool->blocks.pop_back();
+			}
+		}
+#endif /* PATHFINDER_NO_NODE_ARENA */
+		T *item = &(*this)[this->items++];
+		new (item) T;
+		return item;
+	}
+
+	/** indexed access (non-const) */
+	inline T &operator[](uint index)
+	{
+#ifdef PATHFINDER_NO_NODE_ARENA
+		return *this->blocks[index];
+#else
+		return this->blocks[index / B][index % B];
+#endif /* PATHFINDER_NO_NODE_ARENA */
+	}
+
+	/** indexed access (const) */
+	inline const T &operator[](uint index) const
+	{
+#ifdef PATHFINDER_NO_NODE_ARENA
+		return *this->blocks[index];
+#else
+		return this->blocks[index / B][index % B];
+#endif /* PATHFINDER_NO_NODE_ARENA */
+	}
+
+	/**
+	 * Helper for creating a human readable output of this data.
+	 * @param dmp The location to dump to.
+	 */
+	template <typename D> void Dump(D &dmp) const
+	{
+		dmp.WriteLine("num_items = %d", this->items);
+		CStrA name;
+		for (uint i = 0; i < this->items; i++) {
+			name.Format("item[%d]", i);
+			dmp.WriteStructT(name.Data(), &(*this)[i]);
+		}
+	}
+};
+
+#endif /* NODE_ARENA_HPP */
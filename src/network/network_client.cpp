@@ -30,6 +30,8 @@
 #include "network_client.h"
 #include "../core/backup_type.hpp"
 #include "../thread.h"
+#include <condition_variable>
+#include <mutex>
 
 #include "table/strings.h"
 
@@ -38,19 +40,27 @@
 /* This file handles all the client-commands */
 
 
-/** Read some packets, and when do use that data as initial load filter. */
+/**
+ * Read some packets, and when do use that data as initial load filter.
+ * Data can be added while another thread is reading; reads wait for the data to arrive.
+ * Blocks are freed as soon as they have been read, so the data can only be read once.
+ */
 struct PacketReader : LoadFilter {
 	static const size_t CHUNK = 32 * 1024;  ///< 32 KiB chunks of memory.
 
 	std::vector<byte *> blocks;             ///< Buffer with blocks of allocated memory.
-	byte *buf;                              ///< Buffer we're going to write to/read from.
-	byte *bufe;                             ///< End of the buffer we write to/read from.
-	byte **block;                           ///< The block we're reading from/writing to.
+	byte *buf;                              ///< Buffer we're going to write to.
+	byte *bufe;                             ///< End of the buffer we write to.
+	size_t read_block;                      ///< The block we're reading from.
+	size_t read_pos;                        ///< The position in the block we're reading from.
 	size_t written_bytes;                   ///< The total number of bytes we've written.
 	size_t read_bytes;                      ///< The total number of read bytes.
+	bool finished;                          ///< Whether all data has been written.
+	std::mutex mutex;                       ///< Mutex for reading and writing from different threads.
+	std::condition_variable data_sig;       ///< Signal for more data having been written.
 
 	/** Initialise everything. */
-	PacketReader() : LoadFilter(nullptr), buf(nullptr), bufe(nullptr), block(nullptr), written_bytes(0), read_bytes(0)
+	PacketReader() : LoadFilter(nullptr), buf(nullptr), bufe(nullptr), read_block(0), read_pos(0), written_bytes(0), read_bytes(0), finished(false)
 	{
 	}
 
@@ -62,53 +72,72 @@ struct PacketReader : LoadFilter {
 	}
 
 	/**
-	 * Add a packet to this buffer.
-	 * @param p The packet to add.
+	 * Add data to this buffer.
+	 * @param data The data to add.
+	 * @param len  The number of bytes to add.
 	 */
-	void AddPacket(const Packet *p)
+	void Append(const byte *data, size_t len)
 	{
-		assert(this->read_bytes == 0);
+		std::lock_guard<std::mutex> lock(this->mutex);
 
-		size_t in_packet = p->size - p->pos;
-		size_t to_write  = min((size_t)(this->bufe - this->buf), in_packet);
-		const byte *pbuf = p->buffer + p->pos;
+		this->written_bytes += len;
+		while (len != 0) {
+			/* Allocate a new chunk when the current one is full. */
+			if (this->buf == this->bufe) {
+				this->blocks.push_back(this->buf = CallocT<byte>(CHUNK));
+				this->bufe = this->buf + CHUNK;
+			}
 
-		this->written_bytes += in_packet;
-		if (to_write != 0) {
-			memcpy(this->buf, pbuf, to_write);
+			size_t to_write = min((size_t)(this->bufe - this->buf), len);
+			memcpy(this->buf, data, to_write);
 			this->buf += to_write;
+			data += to_write;
+			len -= to_write;
 		}
 
-		/* Did everything fit in the current chunk, then we're done. */
-		if (to_write == in_packet) return;
+		this->data_sig.notify_all();
+	}
 
-		/* Allocate a new chunk and add the remaining data. */
-		pbuf += to_write;
-		to_write   = in_packet - to_write;
-		this->blocks.push_back(this->buf = CallocT<byte>(CHUNK));
-		this->bufe = this->buf + CHUNK;
+	/**
+	 * Add a packet to this buffer.
+	 * @param p The packet to add.
+	 */
+	void AddPacket(const Packet *p)
+	{
+		this->Append(p->buffer + p->pos, p->size - p->pos);
+	}
 
-		memcpy(this->buf, pbuf, to_write);
-		this->buf += to_write;
+	/** Mark that no more data will be added, so reading past the end returns. */
+	void Finish()
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->finished = true;
+		this->data_sig.notify_all();
 	}
 
 	size_t Read(byte *rbuf, size_t size) override
 	{
+		std::unique_lock<std::mutex> lock(this->mutex);
+		this->data_sig.wait(lock, [&]() { return this->finished || this->written_bytes - this->read_bytes >= size; });
+
 		/* Limit the amount to read to whatever we still have. */
 		size_t ret_size = size = min(this->written_bytes - this->read_bytes, size);
 		this->read_bytes += ret_size;
 		const byte *rbufe = rbuf + ret_size;
 
 		while (rbuf != rbufe) {
-			if (this->buf == this->bufe) {
-				this->buf = *this->block++;
-				this->bufe = this->buf + CHUNK;
+			if (this->read_pos == CHUNK) {
+				/* Nothing reads this block again; do not keep all of the savegame in memory. */
+				free(this->blocks[this->read_block]);
+				this->blocks[this->read_block] = nullptr;
+				this->read_block++;
+				this->read_pos = 0;
 			}
 
-			size_t to_write = min(this->bufe - this->buf, rbufe - rbuf);
-			memcpy(rbuf, this->buf, to_write);
+			size_t to_write = min(CHUNK - this->read_pos, (size_t)(rbufe - rbuf));
+			memcpy(rbuf, this->blocks[this->read_block] + this->read_pos, to_write);
 			rbuf += to_write;
-			this->buf += to_write;
+			this->read_pos += to_write;
 		}
 
 		return ret_size;
@@ -116,14 +145,50 @@ struct PacketReader : LoadFilter {
 
 	void Reset() override
 	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (this->read_block != 0) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "the downloaded savegame has been freed while reading it");
 		this->read_bytes = 0;
+		this->read_block = 0;
+		this->read_pos = 0;
+	}
+};
+
+/** Write the decompressed savegame into a packet reader, so it can be loaded from memory. */
+struct PacketReaderWriter : SaveFilter {
+	PacketReader *reader; ///< The reader to add the data to.
+
+	/**
+	 * Initialise this filter.
+	 * @param reader The reader to add the data to.
+	 */
+	PacketReaderWriter(PacketReader *reader) : SaveFilter(nullptr), reader(reader)
+	{
+	}
 
-		this->block = this->blocks.data();
-		this->buf   = *this->block++;
-		this->bufe  = this->buf + CHUNK;
+	void Write(byte *buf, size_t size) override
+	{
+		this->reader->Append(buf, size);
+	}
+
+	void Finish() override
+	{
+		this->reader->Finish();
 	}
 };
 
+/**
+ * Decompress the savegame while it is being downloaded.
+ * @param savegame The reader the downloaded savegame is added to.
+ * @param map      The reader to write the decompressed savegame to.
+ * @param success  Set to whether decompressing succeeded.
+ */
+static void DecompressMapThread(PacketReader *savegame, PacketReader *map, bool *success)
+{
+	PacketReaderWriter writer(map);
+	*success = DecompressSavegame(savegame, &writer);
+	map->Finish();
+}
+
 
 /**
  * Create an emergency savegame when the network connection is lost.
@@ -143,7 +208,7 @@ void ClientNetworkEmergencySave()
  * Create a new socket for the client side of the game connection.
  * @param s The socket to connect with.
  */
-ClientNetworkGameSocketHandler::ClientNetworkGameSocketHandler(SOCKET s) : NetworkGameSocketHandler(s), savegame(nullptr), status(STATUS_INACTIVE)
+ClientNetworkGameSocketHandler::ClientNetworkGameSocketHandler(SOCKET s) : NetworkGameSocketHandler(s), savegame(nullptr), map(nullptr), status(STATUS_INACTIVE)
 {
 	assert(ClientNetworkGameSocketHandler::my_client == nullptr);
 	ClientNetworkGameSocketHandler::my_client = this;
@@ -155,7 +220,31 @@ ClientNetworkGameSocketHandler::~ClientNetworkGameSocketHandler()
 	assert(ClientNetworkGameSocketHandler::my_client == this);
 	ClientNetworkGameSocketHandler::my_client = nullptr;
 
+	this->StopDecompressing();
+	delete this->savegame;
+	delete this->map;
+}
+
+/**
+ * Wait until the downloaded savegame has been decompressed; when the download
+ * is incomplete this aborts the decompression.
+ * @return Whether the whole savegame has been decompressed.
+ */
+bool ClientNetworkGameSocketHandler::StopDecompressing()
+{
+	if (this->savegame == nullptr) return false;
+
+	this->savegame->Finish();
+	if (this->decompress_thread.joinable()) {
+		this->decompress_thread.join();
+	} else {
+		/* Without a thread to decompress while downloading, do it now. */
+		DecompressMapThread(this->savegame, this->map, &this->map_decompressed);
+	}
+
 	delete this->savegame;
+	this->savegame = nullptr;
+	return this->map_decompressed;
 }
 
 NetworkRecvStatus ClientNetworkGameSocketHandler::CloseConnection(NetworkRecvStatus status)
@@ -803,6 +892,13 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_MAP_BEGIN(Packe
 	if (this->savegame != nullptr) return NETWORK_RECV_STATUS_MALFORMED_PACKET;
 
 	this->savegame = new PacketReader();
+	this->map = new PacketReader();
+	this->map_decompressed = false;
+
+	/* Decompress the savegame while it is being downloaded. */
+	if (!StartNewThread(&this->decompress_thread, "ottd:map-decomp", &DecompressMapThread, (PacketReader *)this->savegame, (PacketReader *)this->map, &this->map_decompressed)) {
+		DEBUG(net, 1, "Cannot create map decompression thread, decompressing after the download");
+	}
 
 	_frame_counter = _frame_counter_server = _frame_counter_max = p->Recv_uint32();
 
@@ -848,20 +944,28 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_MAP_DONE(Packet
 	_network_join_status = NETWORK_JOIN_STATUS_PROCESSING;
 	SetWindowDirty(WC_NETWORK_STATUS_WINDOW, WN_NETWORK_STATUS_WINDOW_JOIN);
 
+	/* The map is done downloading; most of it should have been decompressed already. */
+	bool load_success = this->StopDecompressing();
+
 	/*
 	 * Make sure everything is set for reading.
 	 *
-	 * We need the local copy and reset this->savegame because when
+	 * We need the local copy and reset this->map because when
 	 * loading fails the network gets reset upon loading the intro
-	 * game, which would cause us to free this->savegame twice.
+	 * game, which would cause us to free this->map twice.
 	 */
-	LoadFilter *lf = this->savegame;
-	this->savegame = nullptr;
-	lf->Reset();
+	LoadFilter *lf = this->map;
+	this->map = nullptr;
 
-	/* The map is done downloading, load it */
-	ClearErrorMessages();
-	bool load_success = SafeLoad(nullptr, SLO_LOAD, DFT_GAME_FILE, GM_NORMAL, NO_DIRECTORY, lf);
+	if (load_success) {
+		lf->Reset();
+
+		/* Load the decompressed map. */
+		ClearErrorMessages();
+		load_success = SafeLoad(nullptr, SLO_LOAD, DFT_GAME_FILE, GM_NORMAL, NO_DIRECTORY, lf);
+	} else {
+		delete lf;
+	}
 
 	/* Long savegame loads shouldn't affect the lag calculation! */
 	this->last_packet = _realtime_tick;
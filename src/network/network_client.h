@@ -13,11 +13,15 @@
 #define NETWORK_CLIENT_H
 
 #include "network_internal.h"
+#include <thread>
 
 /** Class for handling the client side of the game connection. */
 class ClientNetworkGameSocketHandler : public ZeroedMemoryAllocator, public NetworkGameSocketHandler {
 private:
 	struct PacketReader *savegame; ///< Packet reader for reading the savegame.
+	struct PacketReader *map;      ///< Packet reader for reading the decompressed savegame.
+	std::thread decompress_thread; ///< Thread decompressing the savegame while it is being downloaded.
+	bool map_decompressed;         ///< Whether the savegame has been decompressed successfully.
 	byte token;                    ///< The token we need to send back to the server to prove we're the right client.
 
 	/** Status of the connection with the server. */
@@ -74,6 +78,7 @@ protected:
 	static NetworkRecvStatus SendGetMap();
 	static NetworkRecvStatus SendMapOk();
 	void CheckConnection();
+	bool StopDecompressing();
 public:
 	ClientNetworkGameSocketHandler(SOCKET s);
 	~ClientNetworkGameSocketHandler();
@@ -60,6 +60,7 @@ struct PacketWriter : SaveFilter {
 	Packet *current;                    ///< The packet we're currently writing to.
 	size_t total_size;                  ///< Total size of the compressed savegame.
 	Packet *packets;                    ///< Packet queue of the savegame; send these "slowly" to the client.
+	Packet **packets_end;               ///< Where to append the next packet to the queue.
 	std::mutex mutex;                   ///< Mutex for making threaded saving safe.
 	std::condition_variable exit_sig;   ///< Signal for threaded destruction of this packet writer.
 
@@ -67,7 +68,7 @@ struct PacketWriter : SaveFilter {
 	 * Create the packet writer.
 	 * @param cs The socket handler we're making the packets for.
 	 */
-	PacketWriter(ServerNetworkGameSocketHandler *cs) : SaveFilter(nullptr), cs(cs), current(nullptr), total_size(0), packets(nullptr)
+	PacketWriter(ServerNetworkGameSocketHandler *cs) : SaveFilter(nullptr), cs(cs), current(nullptr), total_size(0), packets(nullptr), packets_end(&packets)
 	{
 	}
 
@@ -136,6 +137,7 @@ struct PacketWriter : SaveFilter {
 
 		Packet *p = this->packets;
 		this->packets = p->next;
+		if (this->packets == nullptr) this->packets_end = &this->packets;
 		p->next = nullptr;
 
 		return p;
@@ -146,11 +148,9 @@ struct PacketWriter : SaveFilter {
 	{
 		if (this->current == nullptr) return;
 
-		Packet **p = &this->packets;
-		while (*p != nullptr) {
-			p = &(*p)->next;
-		}
-		*p = this->current;
+		/* Keep track of the end, so a big map does not make appending ever slower. */
+		*this->packets_end = this->current;
+		this->packets_end = &this->current->next;
 
 		this->current = nullptr;
 	}
@@ -58,6 +58,7 @@
 #include "hotkeys.h"
 #include "newgrf.h"
 #include "misc/getoptdata.h"
+#include "worker_thread.h"
 #include "game/game.hpp"
 #include "game/game_config.hpp"
 #include "town.h"
@@ -66,6 +67,7 @@
 #include "viewport_func.h"
 #include "viewport_sprite_sorter.h"
 #include "framerate_type.h"
+#include "pathfinder/pf_benchmark.h"
 
 #include "linkgraph/linkgraphschedule.h"
 
@@ -304,6 +306,7 @@ static void ShutdownGame()
 	free(_config_file);
 
 	LinkGraphSchedule::Clear();
+	StopWorkerThreads();
 	PoolBase::Clean(PT_ALL);
 
 	/* No NewGRFs were loaded when it was still bootstrapping. */
@@ -1388,6 +1391,7 @@ void StateGameLoop()
 		CallVehicleTicks();
 		CallLandscapeTick();
 		BasePersistentStorageArray::SwitchMode(PSM_LEAVE_GAMELOOP);
+		PfBenchmarkTick();
 
 #ifndef DEBUG_DUMP_COMMANDS
 		{
@@ -1427,6 +1431,7 @@ static void DoAutosave()
 	}
 
 	DEBUG(sl, 2, "Autosaving to '%s'", buf);
+	PerformanceMeasurer framerate(PFE_GL_AUTOSAVE);
 	if (SaveOrLoad(buf, SLO_SAVE, DFT_GAME_FILE, AUTOSAVE_DIR) != SL_OK) {
 		ShowErrorMessage(STR_ERROR_AUTOSAVE_FAILED, INVALID_STRING_ID, WL_ERROR);
 	}
@@ -26,6 +26,7 @@
 #include "../../stdafx.h"
 #include "../../core/alloc_func.hpp"
 #include "aystar.h"
+#include "../pf_benchmark.h"
 
 #include "../../safeguards.h"
 
@@ -47,7 +48,7 @@ PathNode *AyStar::ClosedListIsInList(const AyStarNode *node)
 void AyStar::ClosedListAdd(const PathNode *node)
 {
 	/* Add a node to the ClosedList */
-	PathNode *new_node = MallocT<PathNode>(1);
+	PathNode *new_node = this->closedlist_nodes.AppendC();
 	*new_node = *node;
 	this->closedlist_hash.Set(node->node.tile, node->node.direction, new_node);
 }
@@ -85,7 +86,7 @@ OpenListNode *AyStar::OpenListPop()
 void AyStar::OpenListAdd(PathNode *parent, const AyStarNode *node, int f, int g)
 {
 	/* Add a new Node to the OpenList */
-	OpenListNode *new_node = MallocT<OpenListNode>(1);
+	OpenListNode *new_node = this->openlist_nodes.AppendC();
 	new_node->g = g;
 	new_node->path.parent = parent;
 	new_node->path.node = *node;
@@ -174,7 +175,6 @@ int AyStar::Loop()
 		if (this->FoundEndNode != nullptr) {
 			this->FoundEndNode(this, current);
 		}
-		free(current);
 		return AYSTAR_FOUND_END_NODE;
 	}
 
@@ -190,9 +190,6 @@ int AyStar::Loop()
 		this->CheckTile(&this->neighbours[i], current);
 	}
 
-	/* Free the node */
-	free(current);
-
 	if (this->max_search_nodes != 0 && this->closedlist_hash.GetSize() >= this->max_search_nodes) {
 		/* We've expanded enough nodes */
 		return AYSTAR_LIMIT_REACHED;
@@ -208,10 +205,11 @@ int AyStar::Loop()
 void AyStar::Free()
 {
 	this->openlist_queue.Free(false);
-	/* 2nd argument above is false, below is true, to free the values only
-	 * once */
-	this->openlist_hash.Delete(true);
-	this->closedlist_hash.Delete(true);
+	/* The nodes themselves are stored in the node arenas. */
+	this->openlist_hash.Delete(false);
+	this->closedlist_hash.Delete(false);
+	this->openlist_nodes.Clear();
+	this->closedlist_nodes.Clear();
 #ifdef AYSTAR_DEBUG
 	printf("[AyStar] Memory free'd\n");
 #endif
@@ -223,12 +221,14 @@ void AyStar::Free()
  */
 void AyStar::Clear()
 {
-	/* Clean the Queue, but not the elements within. That will be done by
-	 * the hash. */
+	/* Clean the Queue and the hashes, but not the elements within. Those
+	 * are kept in the node arenas, which keep their memory for the next
+	 * search. */
 	this->openlist_queue.Clear(false);
-	/* Clean the hashes */
-	this->openlist_hash.Clear(true);
-	this->closedlist_hash.Clear(true);
+	this->openlist_hash.Clear(false);
+	this->closedlist_hash.Clear(false);
+	this->openlist_nodes.Clear();
+	this->closedlist_nodes.Clear();
 
 #ifdef AYSTAR_DEBUG
 	printf("[AyStar] Cleared AyStar\n");
@@ -259,6 +259,7 @@ int AyStar::Main()
 	}
 #endif
 	if (r != AYSTAR_STILL_BUSY) {
+		PfBenchmarkAddWork(this->closedlist_hash.GetSize(), 0, 0);
 		/* We're done, clean up */
 		this->Clear();
 	}
@@ -301,6 +302,7 @@ void AyStar::Init(Hash_HashProc hash, uint num_buckets)
 	/* Set up our sorting queue
 	 *  BinaryHeap allocates a block of 1024 nodes
 	 *  When that one gets full it reserves another one, till this number
-	 *  That is why it can stay this high */
+	 *  That is why it can stay this high. The 4-ary heap that is used
+	 *  unless PATHFINDER_BINARY_HEAP is defined grows without limit. */
 	this->openlist_queue.Init(102400);
 }
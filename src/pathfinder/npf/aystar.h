@@ -21,6 +21,8 @@
 #include "queue.h"
 #include "../../tile_type.h"
 #include "../../track_type.h"
+#include "../../misc/dary_heap.hpp"
+#include "../../misc/node_arena.hpp"
 
 //#define AYSTAR_DEBUG
 
@@ -59,6 +61,49 @@ struct OpenListNode {
 	PathNode path;
 };
 
+#ifdef PATHFINDER_BINARY_HEAP
+typedef BinaryHeap AyStarOpenQueue;
+#else
+/**
+ * Open queue of #AyStar, a 4-ary heap of the open nodes keyed by their f-value.
+ * It has the interface of #BinaryHeap, which is used instead when PATHFINDER_BINARY_HEAP is defined.
+ */
+struct AyStarOpenQueue : CDaryHeapT<OpenListNode, 4> {
+	AyStarOpenQueue() : CDaryHeapT<OpenListNode, 4>(1024) {}
+
+	void Init(uint max_size) {}
+
+	bool Push(void *item, int priority)
+	{
+		this->Include((OpenListNode *)item, priority);
+		return true;
+	}
+
+	void *Pop()
+	{
+		return this->IsEmpty() ? nullptr : this->Shift();
+	}
+
+	bool Delete(void *item, int priority)
+	{
+		uint index = this->FindIndex(*(OpenListNode *)item);
+		if (index == 0) return false;
+		this->Remove(index);
+		return true;
+	}
+
+	void Clear(bool free_values)
+	{
+		CDaryHeapT<OpenListNode, 4>::Clear();
+	}
+
+	void Free(bool free_values)
+	{
+		CDaryHeapT<OpenListNode, 4>::Clear();
+	}
+};
+#endif /* PATHFINDER_BINARY_HEAP */
+
 bool CheckIgnoreFirstTile(const PathNode *node);
 
 struct AyStar;
@@ -159,9 +204,12 @@ struct AyStar {
 
 protected:
 	Hash       closedlist_hash; ///< The actual closed list.
-	BinaryHeap openlist_queue;  ///< The open queue.
+	AyStarOpenQueue openlist_queue; ///< The open queue.
 	Hash       openlist_hash;   ///< An extra hash to speed up the process of looking up an element in the open list.
 
+	CNodeArenaT<PathNode> closedlist_nodes;     ///< Storage of the nodes of the closed list, kept between searches.
+	CNodeArenaT<OpenListNode> openlist_nodes;   ///< Storage of the nodes of the open list, kept between searches.
+
 	void OpenListAdd(PathNode *parent, const AyStarNode *node, int f, int g);
 	OpenListNode *OpenListIsInList(const AyStarNode *node);
 	OpenListNode *OpenListPop();
@@ -46,6 +46,12 @@ static const int YAPF_SHIP_PATH_CACHE_LENGTH = 32;
 /** Maximum segments of road vehicle path cache */
 static const int YAPF_ROADVEH_PATH_CACHE_SEGMENTS = 8;
 
+/** Number of cached ship steps left at which the path ahead is searched in advance */
+static const int YAPF_SHIP_PATH_PREFETCH_LENGTH = 8;
+
+/** Number of cached road vehicle choices left at which the path ahead is searched in advance */
+static const int YAPF_ROADVEH_PATH_PREFETCH_SEGMENTS = 2;
+
 /**
  * Helper container to find a depot
  */
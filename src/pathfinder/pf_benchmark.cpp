@@ -0,0 +1,360 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pf_benchmark.cpp Recording and replaying of path finder queries for benchmarking.
+ *
+ * A recording saves the game and then writes the inputs of every track
+ * choice query of trains, road vehicles and ships to a query file next to
+ * that savegame; it does no path finding of its own. A replay runs on the
+ * loaded savegame, with the same or another build. The game then runs the
+ * same ticks again and so asks the same queries in the same state. Each
+ * query the game asks that matches the next recorded one is also run in
+ * isolation right before the game answers it, i.e. on a fresh path finder,
+ * without reserving a path and without touching the path cache of the
+ * vehicle, by the path finder the game is set to use for the vehicle. It is
+ * run twice: first with the segment cost cache of YAPF as the game has it,
+ * then once more after clearing the cache. The caches hold exact costs, so
+ * clearing them does not change how the game continues; NPF has no such
+ * cache, so both of its runs do the same work. The work and latency of both
+ * runs are reported as 'yapf' debug output once all ticks were replayed.
+ * When the build under test routes vehicles differently, the game stops
+ * asking the recorded queries; the report says how many of them were
+ * matched.
+ */
+
+#include "../stdafx.h"
+#include "../debug.h"
+#include "../console_func.h"
+#include "../date_func.h"
+#include "../fileio_func.h"
+#include "../train.h"
+#include "../roadveh.h"
+#include "../ship.h"
+#include "../core/math_func.hpp"
+#include "../core/random_func.hpp"
+#include "../string_func.h"
+#include "../saveload/saveload.h"
+#include "npf/npf_func.h"
+#include "yapf/yapf.h"
+#include "yapf/yapf_cache.h"
+#include "pf_benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "../safeguards.h"
+
+/** The ways a query is replayed. */
+enum PfBenchmarkRun {
+	PBR_WARM,  ///< With the segment cost cache as the game has it.
+	PBR_COLD,  ///< With an empty segment cost cache.
+	PBR_COUNT, ///< Number of ways to replay a query.
+};
+
+/** A recorded path finder query. */
+struct PfBenchmarkQuery {
+	VehicleType type;                ///< Type of the vehicle.
+	VehicleID veh;                   ///< The vehicle.
+	TileIndex tile;                  ///< Tile the vehicle is about to enter.
+	DiagDirection enterdir;          ///< Direction the vehicle enters the tile in.
+	uint choices;                    ///< The tracks or trackdirs to choose from.
+	uint tick;                       ///< Tick of the benchmark the query was done in.
+	bool replayed;                   ///< Whether the game asked the query again in the replay.
+	PfBenchmarkWork work[PBR_COUNT]; ///< Work done by each replay.
+	uint64 latency[PBR_COUNT];       ///< Duration of each replay in nanoseconds.
+};
+
+bool _pf_benchmark_active = false;                      ///< Whether path finder queries are being recorded or replayed.
+thread_local PfBenchmarkWork *_pf_benchmark_work = nullptr; ///< Work of the query that is being replayed on this thread.
+
+static bool _pf_benchmark_replaying = false;                ///< Whether recorded path finder queries are being replayed.
+static FILE *_pf_benchmark_file = nullptr;                  ///< Query file of the recording.
+static std::vector<PfBenchmarkQuery> _pf_benchmark_queries; ///< The queries to replay.
+static size_t _pf_benchmark_next;                           ///< Index of the first recorded query that may still be asked.
+static uint _pf_benchmark_unrecorded;                       ///< Number of queries of the replay that were not recorded.
+static uint _pf_benchmark_ticks;                            ///< Number of ticks of the benchmark.
+static uint _pf_benchmark_tick;                             ///< Number of ticks of the benchmark that have passed.
+
+/**
+ * Stop recording or replaying path finder queries without reporting anything,
+ * e.g. because another game is started or loaded.
+ */
+void ResetPfBenchmark()
+{
+	if (_pf_benchmark_file != nullptr) FioFCloseFile(_pf_benchmark_file);
+	_pf_benchmark_file = nullptr;
+	_pf_benchmark_active = false;
+	_pf_benchmark_replaying = false;
+	_pf_benchmark_queries.clear();
+	_pf_benchmark_queries.shrink_to_fit();
+	_pf_benchmark_next = 0;
+	_pf_benchmark_unrecorded = 0;
+	_pf_benchmark_ticks = 0;
+	_pf_benchmark_tick = 0;
+}
+
+/**
+ * Save the game and start recording the path finder queries of all vehicles.
+ * @param ticks Number of ticks to record queries for.
+ * @param name  Name of the recording; the game is saved as \c name.sav and the queries as \c name.pfq.
+ * @return Whether the recording was started.
+ */
+bool StartPfBenchmarkRecording(uint ticks, const char *name)
+{
+	ResetPfBenchmark();
+
+	char filename[MAX_PATH];
+	seprintf(filename, lastof(filename), "%s.sav", name);
+	if (SaveOrLoad(filename, SLO_SAVE, DFT_GAME_FILE, SAVE_DIR, false) != SL_OK) {
+		IConsoleError("Saving the game for the recording failed");
+		return false;
+	}
+
+	seprintf(filename, lastof(filename), "%s.pfq", name);
+	FILE *f = FioFOpenFile(filename, "w", SAVE_DIR);
+	if (f == nullptr) {
+		IConsolePrintF(CC_ERROR, "Cannot write '%s'", filename);
+		return false;
+	}
+
+	/* The state the replay must start from. */
+	fprintf(f, "%u %d %u %x %x\n", ticks, _date, _date_fract, _random.state[0], _random.state[1]);
+
+	_pf_benchmark_file = f;
+	_pf_benchmark_ticks = ticks;
+	_pf_benchmark_active = true;
+	return true;
+}
+
+/**
+ * Replay a path finder query in isolation.
+ * @param q   The query.
+ * @param v   The vehicle of the query.
+ * @param run The way to replay the query.
+ */
+static void ReplayPfBenchmarkQuery(PfBenchmarkQuery &q, const Vehicle *v, PfBenchmarkRun run)
+{
+	/* Clearing the caches does not change any path, only how long finding it takes. */
+	if (run == PBR_COLD) YapfNotifyTrackLayoutChange(INVALID_TILE, INVALID_TRACK);
+
+	bool path_found;
+	_pf_benchmark_work = &q.work[run];
+	auto start = std::chrono::high_resolution_clock::now();
+	switch (q.type) {
+		case VEH_TRAIN:
+			if (_settings_game.pf.pathfinder_for_trains == VPF_NPF) {
+				NPFTrainChooseTrack(Train::From(v), path_found, false, nullptr);
+			} else {
+				YapfTrainChooseTrack(Train::From(v), q.tile, q.enterdir, (TrackBits)q.choices, path_found, false, nullptr);
+			}
+			break;
+
+		case VEH_ROAD:
+			if (_settings_game.pf.pathfinder_for_roadvehs == VPF_NPF) {
+				NPFRoadVehicleChooseTrack(RoadVehicle::From(v), q.tile, q.enterdir, path_found);
+			} else {
+				RoadVehPathCache path_cache;
+				YapfRoadVehicleChooseTrack(RoadVehicle::From(v), q.tile, q.enterdir, (TrackdirBits)q.choices, path_found, path_cache);
+			}
+			break;
+
+		case VEH_SHIP:
+			if (_settings_game.pf.pathfinder_for_ships == VPF_NPF) {
+				NPFShipChooseTrack(Ship::From(v), path_found);
+			} else {
+				ShipPathCache path_cache;
+				YapfShipChooseTrack(Ship::From(v), q.tile, q.enterdir, (TrackBits)q.choices, path_found, path_cache);
+			}
+			break;
+
+		default: NOT_REACHED();
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	_pf_benchmark_work = nullptr;
+
+	q.latency[run] = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+/**
+ * Handle a path finder query the game is about to answer. While recording,
+ * write it to the query file. While replaying, find it among the recorded
+ * queries of this tick and replay it in isolation in the state the game is
+ * in now.
+ * @param v        The vehicle that does the query.
+ * @param tile     Tile the vehicle is about to enter.
+ * @param enterdir Direction the vehicle enters the tile in.
+ * @param choices  The tracks or trackdirs to choose from.
+ */
+void PfBenchmarkHandleQuery(const Vehicle *v, TileIndex tile, DiagDirection enterdir, uint choices)
+{
+	if (!_pf_benchmark_replaying) {
+		fprintf(_pf_benchmark_file, "%u %u %u %x %d %x\n", _pf_benchmark_tick, (uint)v->type, v->index, tile, (int)enterdir, choices);
+		return;
+	}
+
+	/* This is the query of a replay itself. */
+	if (_pf_benchmark_work != nullptr) return;
+
+	for (size_t i = _pf_benchmark_next; i < _pf_benchmark_queries.size() && _pf_benchmark_queries[i].tick == _pf_benchmark_tick; i++) {
+		PfBenchmarkQuery &q = _pf_benchmark_queries[i];
+		if (q.replayed || q.type != v->type || q.veh != v->index || q.tile != tile || q.enterdir != enterdir || q.choices != choices) continue;
+
+		ReplayPfBenchmarkQuery(q, v, PBR_WARM);
+		ReplayPfBenchmarkQuery(q, v, PBR_COLD);
+		q.replayed = true;
+		return;
+	}
+	_pf_benchmark_unrecorded++;
+}
+
+/**
+ * Skip the recorded queries of the ticks that have passed.
+ */
+static void SkipPfBenchmarkQueries()
+{
+	while (_pf_benchmark_next < _pf_benchmark_queries.size() && _pf_benchmark_queries[_pf_benchmark_next].tick < _pf_benchmark_tick) {
+		_pf_benchmark_next++;
+	}
+}
+
+/**
+ * Start replaying recorded path finder queries.
+ * The game must be the one that was saved for the recording, just loaded.
+ * @param name Name of the recording.
+ * @return Whether the replay was started.
+ */
+bool StartPfBenchmarkReplay(const char *name)
+{
+	ResetPfBenchmark();
+
+	char filename[MAX_PATH];
+	seprintf(filename, lastof(filename), "%s.pfq", name);
+	FILE *f = FioFOpenFile(filename, "r", SAVE_DIR);
+	if (f == nullptr) {
+		IConsolePrintF(CC_ERROR, "Cannot read '%s'", filename);
+		return false;
+	}
+
+	uint ticks;
+	Date date;
+	uint date_fract;
+	uint32 state[2];
+	if (fscanf(f, "%u %d %u %x %x", &ticks, &date, &date_fract, &state[0], &state[1]) != 5) {
+		FioFCloseFile(f);
+		IConsolePrintF(CC_ERROR, "'%s' is not a path finder query recording", filename);
+		return false;
+	}
+	if (date != _date || date_fract != _date_fract || state[0] != _random.state[0] || state[1] != _random.state[1]) {
+		FioFCloseFile(f);
+		IConsolePrintF(CC_ERROR, "The game does not match the recording; load '%s.sav' first", name);
+		return false;
+	}
+
+	PfBenchmarkQuery q;
+	uint type;
+	int enterdir;
+	while (fscanf(f, "%u %u %u %x %d %x", &q.tick, &type, &q.veh, &q.tile, &enterdir, &q.choices) == 6) {
+		q.type = (VehicleType)type;
+		q.enterdir = (DiagDirection)enterdir;
+		q.replayed = false;
+		for (uint run = 0; run < PBR_COUNT; run++) {
+			q.work[run] = PfBenchmarkWork{0, 0, 0};
+			q.latency[run] = 0;
+		}
+		_pf_benchmark_queries.push_back(q);
+	}
+	FioFCloseFile(f);
+
+	/* Start the whole run from empty caches, like the recording did after loading. */
+	YapfNotifyTrackLayoutChange(INVALID_TILE, INVALID_TRACK);
+
+	_pf_benchmark_ticks = ticks;
+	_pf_benchmark_active = true;
+	_pf_benchmark_replaying = true;
+	return true;
+}
+
+/**
+ * Print the report of one way of replaying the queries of one vehicle type.
+ * @param type The vehicle type.
+ * @param name Name of the vehicle type.
+ * @param run  The way the queries were replayed.
+ */
+static void ReportPfBenchmark(VehicleType type, const char *name, PfBenchmarkRun run)
+{
+	std::vector<uint64> latencies;
+	uint64 nodes = 0;
+	uint64 cost_calcs = 0;
+	uint64 cache_hits = 0;
+	for (const PfBenchmarkQuery &q : _pf_benchmark_queries) {
+		if (q.type != type || !q.replayed) continue;
+		latencies.push_back(q.latency[run]);
+		nodes += q.work[run].nodes;
+		cost_calcs += q.work[run].cost_calcs;
+		cache_hits += q.work[run].cache_hits;
+	}
+	if (latencies.empty()) {
+		if (run == PBR_WARM) DEBUG(yapf, 0, "[Benchmark] %s: no queries", name);
+		return;
+	}
+	std::sort(latencies.begin(), latencies.end());
+
+	/* Latency of the given percentile in microseconds. */
+	auto percentile = [&latencies](uint p) -> double {
+		return latencies[min<size_t>(latencies.size() - 1, latencies.size() * p / 100)] / 1000.0;
+	};
+
+	size_t count = latencies.size();
+	double cache_hit_ratio = (cache_hits == 0) ? 0.0 : (double)cache_hits / (double)(cache_hits + cost_calcs) * 100.0;
+	DEBUG(yapf, 0, "[Benchmark] %s, %s cache: %u queries - %.1f nodes/query - CHR %.1f%% - latency us: p50 %.1f, p90 %.1f, p99 %.1f, max %.1f",
+		name, run == PBR_WARM ? "warm" : "cold", (uint)count, (double)nodes / count, cache_hit_ratio,
+		percentile(50), percentile(90), percentile(99), latencies.back() / 1000.0);
+}
+
+/**
+ * Count a game tick of the benchmark. Finish the recording or report the
+ * results of the replay after the last tick.
+ */
+void PfBenchmarkTick()
+{
+	if (!_pf_benchmark_active) return;
+
+	if (++_pf_benchmark_tick < _pf_benchmark_ticks) {
+		if (_pf_benchmark_replaying) SkipPfBenchmarkQueries();
+		return;
+	}
+
+	if (!_pf_benchmark_replaying) {
+		IConsolePrintF(CC_DEFAULT, "Recorded the path finder queries of %u ticks", _pf_benchmark_ticks);
+		ResetPfBenchmark();
+		return;
+	}
+
+	uint replayed = 0;
+	for (const PfBenchmarkQuery &q : _pf_benchmark_queries) {
+		if (!q.replayed) continue;
+		replayed++;
+		DEBUG(yapf, 1, "[Benchmark] tick %u - vehicle %u - tile 0x%x dir %d choices 0x%x - warm: %u nodes, %u calcs, %u hits, %.1f us - cold: %u nodes, %u calcs, %u hits, %.1f us",
+			q.tick, q.veh, q.tile, q.enterdir, q.choices,
+			q.work[PBR_WARM].nodes, q.work[PBR_WARM].cost_calcs, q.work[PBR_WARM].cache_hits, q.latency[PBR_WARM] / 1000.0,
+			q.work[PBR_COLD].nodes, q.work[PBR_COLD].cost_calcs, q.work[PBR_COLD].cache_hits, q.latency[PBR_COLD] / 1000.0);
+	}
+
+	DEBUG(yapf, 0, "[Benchmark] Replayed %u of %u recorded path finder queries of %u ticks; the game asked %u queries that were not recorded",
+		replayed, (uint)_pf_benchmark_queries.size(), _pf_benchmark_ticks, _pf_benchmark_unrecorded);
+	ReportPfBenchmark(VEH_TRAIN, "Trains", PBR_WARM);
+	ReportPfBenchmark(VEH_TRAIN, "Trains", PBR_COLD);
+	ReportPfBenchmark(VEH_ROAD, "Road vehicles", PBR_WARM);
+	ReportPfBenchmark(VEH_ROAD, "Road vehicles", PBR_COLD);
+	ReportPfBenchmark(VEH_SHIP, "Ships", PBR_WARM);
+	ReportPfBenchmark(VEH_SHIP, "Ships", PBR_COLD);
+
+	ResetPfBenchmark();
+}
@@ -0,0 +1,50 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file pf_benchmark.h Recording and replaying of path finder queries for benchmarking. */
+
+#ifndef PF_BENCHMARK_H
+#define PF_BENCHMARK_H
+
+#include "../vehicle_type.h"
+#include "../tile_type.h"
+#include "../direction_type.h"
+
+/** Work done by the path finder for a replayed query. */
+struct PfBenchmarkWork {
+	uint nodes;      ///< Number of nodes that were expanded.
+	uint cost_calcs; ///< Number of node costs that were calculated.
+	uint cache_hits; ///< Number of node costs that were taken from the segment cache.
+};
+
+extern bool _pf_benchmark_active;
+extern thread_local PfBenchmarkWork *_pf_benchmark_work;
+
+bool StartPfBenchmarkRecording(uint ticks, const char *name);
+bool StartPfBenchmarkReplay(const char *name);
+void ResetPfBenchmark();
+void PfBenchmarkTick();
+void PfBenchmarkHandleQuery(const Vehicle *v, TileIndex tile, DiagDirection enterdir, uint choices);
+
+/**
+ * Add the work of a path finder run to the replayed query of this thread, if any.
+ * @param nodes      Number of nodes that were expanded.
+ * @param cost_calcs Number of node costs that were calculated.
+ * @param cache_hits Number of node costs that were taken from the segment cache.
+ */
+static inline void PfBenchmarkAddWork(uint nodes, uint cost_calcs, uint cache_hits)
+{
+	PfBenchmarkWork *work = _pf_benchmark_work;
+	if (work == nullptr) return;
+	work->nodes += nodes;
+	work->cost_calcs += cost_calcs;
+	work->cache_hits += cache_hits;
+}
+
+#endif /* PF_BENCHMARK_H */
@@ -12,24 +12,31 @@
 #ifndef NODELIST_HPP
 #define NODELIST_HPP
 
-#include "../../misc/array.hpp"
 #include "../../misc/hashtable.hpp"
 #include "../../misc/binaryheap.hpp"
+#include "../../misc/dary_heap.hpp"
+#include "../../misc/node_arena.hpp"
 
 /**
  * Hash table based node list multi-container class.
  *  Implements open list, closed list and priority queue for A-star
- *  path finder.
+ *  path finder. The open nodes are ordered by a 4-ary heap keyed by their
+ *  cost estimates; define PATHFINDER_BINARY_HEAP to use the binary heap
+ *  that compares the nodes themselves instead, e.g. for comparing both.
  */
 template <class Titem_, int Thash_bits_open_, int Thash_bits_closed_>
 class CNodeList_HashTableT {
 public:
 	typedef Titem_ Titem;                                        ///< Make #Titem_ visible from outside of class.
 	typedef typename Titem_::Key Key;                            ///< Make Titem_::Key a property of this class.
-	typedef SmallArray<Titem_, 65536, 256> CItemArray;           ///< Type that we will use as item container.
+	typedef CNodeArenaT<Titem_, 256> CItemArray;                 ///< Type that we will use as item container.
 	typedef CHashTableT<Titem_, Thash_bits_open_  > COpenList;   ///< How pointers to open nodes will be stored.
 	typedef CHashTableT<Titem_, Thash_bits_closed_> CClosedList; ///< How pointers to closed nodes will be stored.
+#ifdef PATHFINDER_BINARY_HEAP
 	typedef CBinaryHeapT<Titem_> CPriorityQueue;                 ///< How the priority queue will be managed.
+#else
+	typedef CDaryHeapT<Titem_, 4> CPriorityQueue;                ///< How the priority queue will be managed.
+#endif
 
 protected:
 	CItemArray      m_arr;        ///< Here we store full item data (Titem_).
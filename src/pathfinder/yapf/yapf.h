@@ -37,6 +37,16 @@ Track YapfShipChooseTrack(const Ship *v, TileIndex tile, DiagDirection enterdir,
  */
 bool YapfShipCheckReverse(const Ship *v);
 
+/**
+ * Search the path of a ship beyond the end of its cached path.
+ * The search only reads the game state, so it may run on a worker thread.
+ * @param v     the ship
+ * @param tile  the tile the first step of the cached path follows
+ * @param td    the trackdir the first step of the cached path follows
+ * @param ahead [out] the steps following the cached path; empty if no path was found
+ */
+void YapfShipFindPathAhead(const Ship *v, TileIndex tile, Trackdir td, ShipPathCache &ahead);
+
 /**
  * Finds the best path for given road vehicle using YAPF.
  * @param v         the RV that needs to find a path
@@ -48,6 +58,14 @@ bool YapfShipCheckReverse(const Ship *v);
  */
 Trackdir YapfRoadVehicleChooseTrack(const RoadVehicle *v, TileIndex tile, DiagDirection enterdir, TrackdirBits trackdirs, bool &path_found, RoadVehPathCache &path_cache);
 
+/**
+ * Search the path of a road vehicle beyond the last choice of its cached path.
+ * The search only reads the game state, so it may run on a worker thread.
+ * @param v     the RV, with a non-empty path cache
+ * @param ahead [out] the choices following the cached path; empty if no path was found
+ */
+void YapfRoadVehicleFindPathAhead(const RoadVehicle *v, RoadVehPathCache &ahead);
+
 /**
  * Finds the best path for given train using YAPF.
  * @param v        the train that needs to find a path
@@ -99,4 +117,11 @@ bool YapfTrainCheckReverse(const Train *v);
  */
 bool YapfTrainFindNearestSafeTile(const Train *v, TileIndex tile, Trackdir td, bool override_railtype);
 
+/**
+ * Forget the destinations trains did not reach on the junction graph.
+ * @param vehicle_ticks Whether the vehicle ticks start, so the destinations
+ *                      not reached are remembered until they end.
+ */
+void YapfResetJunctionSearchMisses(bool vehicle_ticks);
+
 #endif /* YAPF_H */
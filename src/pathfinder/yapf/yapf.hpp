@@ -13,8 +13,10 @@
 #define YAPF_HPP
 
 #include "../../landscape.h"
+#include "../../tilearea_type.h"
 #include "../pathfinder_func.h"
 #include "../pf_performance_timer.hpp"
+#include "../pf_benchmark.h"
 #include "yapf.h"
 
 //#undef FORCEINLINE
@@ -26,6 +28,8 @@
 #include "../../misc/array.hpp"
 #include "../../misc/hashtable.hpp"
 #include "../../misc/binaryheap.hpp"
+#include "../../misc/dary_heap.hpp"
+#include "../../misc/node_arena.hpp"
 #include "../../misc/dbg_helpers.h"
 #include "nodelist.hpp"
 #include "../follow_track.hpp"
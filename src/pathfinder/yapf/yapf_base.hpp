@@ -153,6 +153,7 @@ public:
 		bDestFound &= (m_pBestDestNode != nullptr);
 
 		perf.Stop();
+		PfBenchmarkAddWork(m_nodes.ClosedCount(), m_stats_cost_calcs, m_stats_cache_hits);
 		if (_debug_yapf_level >= 2) {
 			int t = perf.Get(1000000);
 			_total_pf_time_us += t;
@@ -13,6 +13,7 @@
 #define YAPF_COSTCACHE_HPP
 
 #include "../../date_func.h"
+#include <vector>
 
 /**
  * CYapfSegmentCostCacheNoneT - the formal only yapf cost cache provider that implements
@@ -93,18 +94,28 @@ public:
 
 
 /**
- * Base class for segment cost cache providers. Contains global counter
- *  of track layout changes and static notification function called whenever
+ * Base class for segment cost cache providers. Contains the global log of
+ *  track layout changes and static notification function called whenever
  *  the track layout changes. It is implemented as base class because it needs
- *  to be shared between all rail YAPF types (one shared counter, one notification
- *  function.
+ *  to be shared between all rail YAPF types (one shared log, one notification
+ *  function). Every cache applies the changes it has not seen yet the next time
+ *  it is used, so only the segments near the changed tiles are forgotten.
  */
 struct CSegmentCostCacheBase
 {
-	static int   s_rail_change_counter;
+	static const uint C_CHANGE_LOG_SIZE = 4096; ///< Number of track layout changes remembered; caches that missed more are flushed.
+
+	static uint      s_rail_change_counter;                ///< Number of track layout changes so far.
+	static TileIndex s_rail_change_log[C_CHANGE_LOG_SIZE]; ///< Tiles of the last track layout changes, INVALID_TILE if everything changed.
+
+	static uint64    s_stats_hits;        ///< Number of segments whose cost was taken from a cache.
+	static uint64    s_stats_misses;      ///< Number of segments whose cost had to be calculated.
+	static uint64    s_stats_invalidated; ///< Number of cached segments forgotten because of a track layout change near them.
+	static uint64    s_stats_flushes;     ///< Number of times a whole cache was forgotten.
 
 	static void NotifyTrackLayoutChange(TileIndex tile, Track track)
 	{
+		s_rail_change_log[s_rail_change_counter % C_CHANGE_LOG_SIZE] = tile;
 		s_rail_change_counter++;
 	}
 };
@@ -118,26 +129,39 @@ struct CSegmentCostCacheBase
  *  be always the same (TileIndex + DiagDirection) that represent the beginning
  *  of the segment (origin tile and exit-dir from this tile).
  *  Different CYapfCachedCostT types can share the same type of CSegmentCostCacheT.
- *  Look at CYapfRailSegment (yapf_node_rail.hpp) for the segment example
+ *  Look at CYapfRailSegment (yapf_node_rail.hpp) for the segment example.
+ *  The calculated segments are indexed by the map cells their tiles are in, so
+ *  a track layout change only resets the segments on or next to the changed tile.
  */
 template <class Tsegment>
 struct CSegmentCostCacheT : public CSegmentCostCacheBase {
 	static const int C_HASH_BITS = 14;
+	static const uint C_CELL_BITS = 5; ///< Log2 of the size of the square cells of the spatial index, in tiles.
 
 	typedef CHashTableT<Tsegment, C_HASH_BITS> HashTable;
 	typedef SmallArray<Tsegment> Heap;
 	typedef typename Tsegment::Key Key;    ///< key to hash table
+	typedef std::vector<Tsegment *> SegmentVector;
 
 	HashTable    m_map;
 	Heap         m_heap;
+	std::vector<SegmentVector> m_cells; ///< Spatial index; segments by the cells their tiles are in or next to. May contain outdated entries.
+	SegmentVector m_unindexed;          ///< Segments handed out for calculation since the last update, not yet in the spatial index.
+	size_t       m_index_size;          ///< Number of entries in the spatial index.
+	uint         m_change_counter;      ///< Value of s_rail_change_counter the cache is up to date with.
+	uint         m_map_size;            ///< Size of the map the cache was filled for.
 
-	inline CSegmentCostCacheT() {}
+	inline CSegmentCostCacheT() : m_index_size(0), m_change_counter(0), m_map_size(0) {}
 
 	/** flush (clear) the cache */
 	inline void Flush()
 	{
+		if (m_heap.Length() != 0) s_stats_flushes++;
 		m_map.Clear();
 		m_heap.Clear();
+		m_cells.clear();
+		m_unindexed.clear();
+		m_index_size = 0;
 	}
 
 	inline Tsegment& Get(Key &key, bool *found)
@@ -150,8 +174,136 @@ struct CSegmentCostCacheT : public CSegmentCostCacheBase {
 		} else {
 			*found = true;
 		}
+		if (item->m_cost < 0) {
+			/* It is going to be calculated now; index it on the next update. */
+			s_stats_misses++;
+			m_unindexed.push_back(item);
+		} else {
+			s_stats_hits++;
+		}
 		return *item;
 	}
+
+	/**
+	 * Bring the cache up to date with the track layout changes made since it
+	 *  was last used. Must not be called while a pathfinder is using the cache.
+	 */
+	void Update()
+	{
+		if (m_map_size != MapSize()) {
+			Flush();
+			m_map_size = MapSize();
+			m_change_counter = s_rail_change_counter;
+			return;
+		}
+
+		for (Tsegment *segment : m_unindexed) {
+			if (segment->m_cost >= 0) AddToIndex(segment);
+		}
+		m_unindexed.clear();
+
+		if (s_rail_change_counter - m_change_counter > C_CHANGE_LOG_SIZE) {
+			Flush();
+		} else {
+			for (uint i = m_change_counter; i != s_rail_change_counter; i++) {
+				TileIndex tile = s_rail_change_log[i % C_CHANGE_LOG_SIZE];
+				if (tile == INVALID_TILE) {
+					Flush();
+					break;
+				}
+				Invalidate(tile);
+			}
+		}
+		m_change_counter = s_rail_change_counter;
+
+		/* Drop the outdated entries if they start to dominate the index. */
+		if (m_index_size > 4 * (size_t)m_heap.Length() + 4096) RebuildIndex();
+	}
+
+protected:
+	/**
+	 * Get the spatial index cell a tile belongs to.
+	 * @param x X coordinate of the tile.
+	 * @param y Y coordinate of the tile.
+	 * @return Index into m_cells.
+	 */
+	static inline uint GetCell(uint x, uint y)
+	{
+		return (y >> C_CELL_BITS) * (MapSizeX() >> C_CELL_BITS) + (x >> C_CELL_BITS);
+	}
+
+	/**
+	 * Check whether a tile is one of the tiles of a segment or next to them.
+	 *  The segment depends on the neighbouring tiles too, as it ends there.
+	 * @param segment Calculated segment.
+	 * @param tile Tile to check.
+	 * @return True if a change on \a tile may change the segment.
+	 */
+	static inline bool IsNearSegment(const Tsegment *segment, TileIndex tile)
+	{
+		const TileArea &area = segment->m_area;
+		uint x = TileX(tile);
+		uint y = TileY(tile);
+		return x + 1 >= TileX(area.tile) && x <= TileX(area.tile) + area.w &&
+				y + 1 >= TileY(area.tile) && y <= TileY(area.tile) + area.h;
+	}
+
+	/**
+	 * Add a calculated segment to the cells of the spatial index its tiles are in or next to.
+	 * @param segment Segment to add.
+	 */
+	void AddToIndex(Tsegment *segment)
+	{
+		if (m_cells.empty()) m_cells.resize(GetCell(MapMaxX(), MapMaxY()) + 1);
+
+		const TileArea &area = segment->m_area;
+		uint x0 = TileX(area.tile) == 0 ? 0 : TileX(area.tile) - 1;
+		uint y0 = TileY(area.tile) == 0 ? 0 : TileY(area.tile) - 1;
+		uint x1 = min<uint>(TileX(area.tile) + area.w, MapMaxX());
+		uint y1 = min<uint>(TileY(area.tile) + area.h, MapMaxY());
+		for (uint y = y0 >> C_CELL_BITS; y <= y1 >> C_CELL_BITS; y++) {
+			for (uint x = x0 >> C_CELL_BITS; x <= x1 >> C_CELL_BITS; x++) {
+				m_cells[GetCell(x << C_CELL_BITS, y << C_CELL_BITS)].push_back(segment);
+				m_index_size++;
+			}
+		}
+	}
+
+	/**
+	 * Reset the segments a track layout change on a tile may have changed.
+	 * @param tile Changed tile.
+	 */
+	void Invalidate(TileIndex tile)
+	{
+		if (m_cells.empty()) return;
+
+		SegmentVector &cell = m_cells[GetCell(TileX(tile), TileY(tile))];
+		for (size_t i = 0; i < cell.size();) {
+			Tsegment *segment = cell[i];
+			if (segment->m_cost >= 0) {
+				if (!IsNearSegment(segment, tile)) {
+					i++;
+					continue;
+				}
+				segment->Reset();
+				s_stats_invalidated++;
+			}
+			/* Either reset now or earlier; its entry is outdated anyway. */
+			cell[i] = cell.back();
+			cell.pop_back();
+			m_index_size--;
+		}
+	}
+
+	/** Rebuild the spatial index from the calculated segments, dropping all outdated entries. */
+	void RebuildIndex()
+	{
+		m_cells.clear();
+		m_index_size = 0;
+		for (uint i = 0; i < m_heap.Length(); i++) {
+			if (m_heap[i].m_cost >= 0) AddToIndex(&m_heap[i]);
+		}
+	}
 };
 
 /**
@@ -183,7 +335,6 @@ protected:
 
 	inline static Cache& stGetGlobalCache()
 	{
-		static int last_rail_change_counter = 0;
 		static Date last_date = 0;
 		static Cache C;
 
@@ -194,11 +345,8 @@ protected:
 			_total_pf_time_us = 0;
 		}
 
-		/* delete the cache sometimes... */
-		if (last_rail_change_counter != Cache::s_rail_change_counter) {
-			last_rail_change_counter = Cache::s_rail_change_counter;
-			C.Flush();
-		}
+		/* forget the segments the track layout changed at */
+		C.Update();
 		return C;
 	}
 
@@ -373,6 +373,9 @@ public:
 
 no_entry_cost: // jump here at the beginning if the node has no parent (it is the first node)
 
+			/* Remember the tiles of the segment for invalidating it later. */
+			segment.m_area.Add(cur.tile);
+
 			/* All other tile costs will be calculated here. */
 			segment_cost += Yapf().OneTileCost(cur.tile, cur.td);
 
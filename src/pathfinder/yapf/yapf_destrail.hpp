@@ -181,15 +181,28 @@ public:
 	 */
 	inline bool PfCalcEstimate(Node &n)
 	{
-		static const int dg_dir_to_x_offs[] = {-1, 0, 1, 0};
-		static const int dg_dir_to_y_offs[] = {0, 1, 0, -1};
 		if (PfDetectDestination(n)) {
 			n.m_estimate = n.m_cost;
 			return true;
 		}
 
-		TileIndex tile = n.GetLastTile();
-		DiagDirection exitdir = TrackdirToExitdir(n.GetLastTrackdir());
+		n.m_estimate = n.m_cost + EstimateDistance(n.GetLastTile(), n.GetLastTrackdir());
+		assert(n.m_estimate >= n.m_parent->m_estimate);
+		return true;
+	}
+
+	/**
+	 * Estimate the remaining cost from leaving a tile to the destination.
+	 * @param tile Tile to leave.
+	 * @param td Trackdir to leave the tile with.
+	 * @return Lower bound of the cost to the destination.
+	 */
+	inline int EstimateDistance(TileIndex tile, Trackdir td) const
+	{
+		static const int dg_dir_to_x_offs[] = {-1, 0, 1, 0};
+		static const int dg_dir_to_y_offs[] = {0, 1, 0, -1};
+
+		DiagDirection exitdir = TrackdirToExitdir(td);
 		int x1 = 2 * TileX(tile) + dg_dir_to_x_offs[(int)exitdir];
 		int y1 = 2 * TileY(tile) + dg_dir_to_y_offs[(int)exitdir];
 		int x2 = 2 * TileX(m_destTile);
@@ -198,10 +211,7 @@ public:
 		int dy = abs(y1 - y2);
 		int dmin = min(dx, dy);
 		int dxy = abs(dx - dy);
-		int d = dmin * YAPF_TILE_CORNER_LENGTH + (dxy - 1) * (YAPF_TILE_LENGTH / 2);
-		n.m_estimate = n.m_cost + d;
-		assert(n.m_estimate >= n.m_parent->m_estimate);
-		return true;
+		return dmin * YAPF_TILE_CORNER_LENGTH + (dxy - 1) * (YAPF_TILE_LENGTH / 2);
 	}
 };
 
@@ -73,6 +73,10 @@ struct CYapfRailSegment
 	TileIndex              m_last_signal_tile;
 	Trackdir               m_last_signal_td;
 	EndSegmentReasonBits   m_end_segment_reason;
+	TileArea               m_area;        ///< Tiles the segment passes, to find it when the track layout there changes.
+	CYapfRailSegment      *m_next[3];     ///< Segments that can follow this one in the junction graph, nullptr if there are fewer.
+	int                    m_next_cost[3];///< Costs of the transitions into the segments that can follow this one.
+	bool                   m_next_known;  ///< Whether m_next and m_next_cost are filled.
 	CYapfRailSegment      *m_hash_next;
 
 	inline CYapfRailSegment(const CYapfRailSegmentKey &key)
@@ -83,9 +87,23 @@ struct CYapfRailSegment
 		, m_last_signal_tile(INVALID_TILE)
 		, m_last_signal_td(INVALID_TRACKDIR)
 		, m_end_segment_reason(ESRB_NONE)
+		, m_next_known(false)
 		, m_hash_next(nullptr)
 	{}
 
+	/** Forget the calculated data, so the segment is calculated again the next time it is used. */
+	inline void Reset()
+	{
+		m_last_tile = INVALID_TILE;
+		m_last_td = INVALID_TRACKDIR;
+		m_cost = -1;
+		m_last_signal_tile = INVALID_TILE;
+		m_last_signal_td = INVALID_TRACKDIR;
+		m_end_segment_reason = ESRB_NONE;
+		m_area.Clear();
+		m_next_known = false;
+	}
+
 	inline const Key& GetKey() const
 	{
 		return m_key;
@@ -225,4 +243,57 @@ typedef CYapfRailNodeT<CYapfNodeKeyTrackDir> CYapfRailNodeTrackDir;
 typedef CNodeList_HashTableT<CYapfRailNodeExitDir , 8, 10> CRailNodeListExitDir;
 typedef CNodeList_HashTableT<CYapfRailNodeTrackDir, 8, 10> CRailNodeListTrackDir;
 
+/**
+ * Node for searching the junction graph of the rail network, whose nodes are
+ * the calculated segments and whose edges are the transitions between them.
+ * Used to continue a rail search that ran out of tile level nodes.
+ */
+template <class Tnode>
+struct CYapfRailJunctionT
+{
+	typedef CYapfNodeKeyTrackDir Key;
+
+	Key                 m_key;       ///< Start of the segment.
+	CYapfRailJunctionT *m_hash_next;
+	Tnode              *m_origin;    ///< Tile level node the path to this junction left the tile level search at.
+	CYapfRailSegment   *m_segment;   ///< Segment starting at this junction.
+	int                 m_cost;
+	int                 m_estimate;
+
+	inline void Set(Tnode *origin, CYapfRailSegment *segment, int cost, int estimate)
+	{
+		m_key.Set(segment->GetTile(), segment->m_key.GetTrackdir());
+		m_hash_next = nullptr;
+		m_origin = origin;
+		m_segment = segment;
+		m_cost = cost;
+		m_estimate = estimate;
+	}
+
+	inline const Key& GetKey() const
+	{
+		return m_key;
+	}
+
+	inline CYapfRailJunctionT *GetHashNext()
+	{
+		return m_hash_next;
+	}
+
+	inline void SetHashNext(CYapfRailJunctionT *next)
+	{
+		m_hash_next = next;
+	}
+
+	inline int GetCostEstimate() const
+	{
+		return m_estimate;
+	}
+
+	inline bool operator<(const CYapfRailJunctionT &other) const
+	{
+		return m_estimate < other.m_estimate;
+	}
+};
+
 #endif /* YAPF_NODE_RAIL_HPP */
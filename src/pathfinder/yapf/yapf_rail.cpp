@@ -18,6 +18,10 @@
 #include "yapf_destrail.hpp"
 #include "../../viewport_func.h"
 #include "../../newgrf_station.h"
+#include "../../console_func.h"
+#include "../../depot_func.h"
+#include <algorithm>
+#include <vector>
 
 #include "../../safeguards.h"
 
@@ -182,7 +186,11 @@ public:
 		if (target != nullptr) target->okay = true;
 
 		if (Yapf().CanUseGlobalCache(*m_res_node)) {
-			YapfNotifyTrackLayoutChange(INVALID_TILE, INVALID_TRACK);
+			/* Forget the cached costs of the segments along the reservation. */
+			for (Node *node = m_res_node; node->m_parent != nullptr; node = node->m_parent) {
+				CSegmentCostCacheBase::NotifyTrackLayoutChange(node->GetTile(), INVALID_TRACK);
+				CSegmentCostCacheBase::NotifyTrackLayoutChange(node->GetLastTile(), INVALID_TRACK);
+			}
 		}
 
 		return true;
@@ -363,6 +371,34 @@ public:
 	}
 };
 
+/** Destination a train did not reach on the junction graph during the current vehicle ticks. */
+struct JunctionSearchMiss {
+	Owner owner;         ///< Owner of the train, whose track was searched.
+	RailTypes railtypes; ///< Rail types the train can use.
+	StationID station;   ///< Station or waypoint the train heads to, or INVALID_STATION.
+	TileIndex tile;      ///< Tile the train heads to when it does not head to a station or waypoint.
+
+	inline bool operator==(const JunctionSearchMiss &other) const
+	{
+		return this->owner == other.owner && this->railtypes == other.railtypes && this->station == other.station && this->tile == other.tile;
+	}
+};
+
+/**
+ * Destinations the junction graph search did not reach during the current
+ * vehicle ticks. Whether a search reaches its destination depends on where
+ * the train is, so they are only remembered while all trains move in the
+ * same order on all clients.
+ */
+static std::vector<JunctionSearchMiss> _junction_search_misses;
+static bool _junction_search_misses_active = false; ///< Whether the vehicle ticks are running, i.e. junction search misses may be remembered.
+
+void YapfResetJunctionSearchMisses(bool vehicle_ticks)
+{
+	_junction_search_misses.clear();
+	_junction_search_misses_active = vehicle_ticks;
+}
+
 template <class Types>
 class CYapfFollowRailT : public CYapfReserveTrack<Types>
 {
@@ -371,6 +407,8 @@ public:
 	typedef typename Types::TrackFollower TrackFollower;
 	typedef typename Types::NodeList::Titem Node;        ///< this will be our node type
 	typedef typename Node::Key Key;                      ///< key to hash tables
+	typedef CYapfRailJunctionT<Node> Junction;           ///< node of the junction graph search
+	typedef CNodeList_HashTableT<Junction, 10, 12> JunctionList;
 
 protected:
 	/** to access inherited path finder */
@@ -379,6 +417,122 @@ protected:
 		return *static_cast<Tpf *>(this);
 	}
 
+	/**
+	 * Fill the edges of the junction graph leaving a segment, i.e. the segments
+	 *  that can follow it and the cost of the transitions into them. Segments
+	 *  that are not calculated yet are calculated at tile level now, as if they
+	 *  were far enough away from the train to be cached.
+	 * @param segment Calculated segment to follow.
+	 */
+	void FollowJunction(CYapfRailSegment *segment)
+	{
+		for (uint i = 0; i < lengthof(segment->m_next); i++) segment->m_next[i] = nullptr;
+		segment->m_next_known = true;
+
+		/* Follow with all rail types; which ones a train may use is checked while searching.
+		 * INVALID_RAILTYPES cannot be used for that as the track follower rejects it. */
+		RailTypes railtypes = _railtypes_hidden_mask;
+		for (RailType rt : _sorted_railtypes) SetBit(railtypes, rt);
+		TrackFollower F(Yapf().GetVehicle()->owner, railtypes);
+		if (!F.Follow(segment->m_last_tile, segment->m_last_td)) return;
+
+		Node parent;
+		parent.Set(nullptr, segment->GetTile(), segment->m_key.GetTrackdir(), true);
+		parent.m_segment = segment;
+		parent.m_num_signals_passed = Yapf().PfGetSettings().rail_look_ahead_max_signals;
+
+		bool is_choice = KillFirstBit(F.m_new_td_bits) != TRACKDIR_BIT_NONE;
+		uint i = 0;
+		for (TrackdirBits rtds = F.m_new_td_bits; rtds != TRACKDIR_BIT_NONE; rtds = KillFirstBit(rtds)) {
+			Trackdir td = (Trackdir)FindFirstBit2x64(rtds);
+			Node n;
+			n.Set(&parent, F.m_new_tile, td, is_choice);
+			Yapf().PfNodeCacheFetch(n);
+			if (n.m_segment->m_cost < 0) Yapf().PfCalcCost(n, &F);
+			if (n.m_segment->m_cost < 0) continue; // Too long to calculate.
+
+			assert(i < lengthof(segment->m_next));
+			segment->m_next[i] = n.m_segment;
+			segment->m_next_cost[i] = Yapf().CurveCost(segment->m_last_td, td) + Yapf().SwitchCost(segment->m_last_tile, F.m_new_tile, TrackdirToExitdir(segment->m_last_td));
+			i++;
+		}
+	}
+
+	/**
+	 * Continue a search that ran out of tile level nodes on the junction graph.
+	 *  The open tile level nodes are the starting points; from there on only
+	 *  whole segments are followed, using the cached segment costs and the
+	 *  transitions between the segments. Changes to the track layout reset the
+	 *  affected parts of the graph together with the segment cost cache.
+	 * @param max_junctions Number of junctions the search may visit.
+	 * @return The open tile level node the best path to the destination leaves
+	 *  the tile level search at, or nullptr if there is none.
+	 */
+	Node *FindPathOnJunctionGraph(int max_junctions)
+	{
+		const Train *v = Yapf().GetVehicle();
+		JunctionList junctions;
+
+		for (int i = 0; i < Yapf().m_nodes.TotalCount(); i++) {
+			Node &n = Yapf().m_nodes.ItemAt(i);
+			if (Yapf().m_nodes.FindOpenNode(n.GetKey()) != &n) continue;
+			Junction &j = *junctions.CreateNewNode();
+			j.Set(&n, n.m_segment, n.m_cost, n.m_estimate);
+			junctions.InsertOpenNode(j);
+		}
+
+		Junction *best = nullptr;
+		for (;;) {
+			Junction *j = junctions.GetBestOpenNode();
+			if (j == nullptr || junctions.ClosedCount() >= max_junctions) break;
+			if (best != nullptr && best->m_cost < j->m_estimate) break;
+			junctions.PopOpenNode(j->GetKey());
+			junctions.InsertClosedNode(*j);
+
+			CYapfRailSegment *segment = j->m_segment;
+			bool known = segment->m_next_known;
+			for (uint i = 0; known && i < lengthof(segment->m_next) && segment->m_next[i] != nullptr; i++) {
+				if (segment->m_next[i]->m_cost < 0) known = false;
+			}
+			if (!known) FollowJunction(segment);
+
+			for (uint i = 0; i < lengthof(segment->m_next) && segment->m_next[i] != nullptr; i++) {
+				CYapfRailSegment *next = segment->m_next[i];
+				if (!HasBit(v->compatible_railtypes, GetTileRailType(next->GetTile()))) continue;
+
+				Junction &n = *junctions.CreateNewNode();
+				n.Set(j->m_origin, next, j->m_cost + segment->m_next_cost[i] + next->m_cost, 0);
+
+				/* Junctions the tile level search has been at already have their best cost. */
+				if (Yapf().m_nodes.FindClosedNode(n.GetKey()) != nullptr) continue;
+				if (junctions.FindClosedNode(n.GetKey()) != nullptr) continue;
+
+				if ((next->m_end_segment_reason & ESRB_POSSIBLE_TARGET) != ESRB_NONE && Yapf().PfDetectDestination(next->m_last_tile, next->m_last_td)) {
+					if (best == nullptr || n.m_cost < best->m_cost) {
+						n.m_estimate = n.m_cost;
+						best = &n;
+						junctions.FoundBestNode(n);
+					}
+					continue;
+				}
+				if ((next->m_end_segment_reason & ESRB_ABORT_PF_MASK) != ESRB_NONE) continue;
+
+				n.m_estimate = n.m_cost + Yapf().EstimateDistance(next->m_last_tile, next->m_last_td);
+				Junction *open = junctions.FindOpenNode(n.GetKey());
+				if (open == nullptr) {
+					junctions.InsertOpenNode(n);
+				} else if (n.m_estimate < open->m_estimate) {
+					junctions.PopOpenNode(n.GetKey());
+					*open = n;
+					junctions.InsertOpenNode(*open);
+				}
+			}
+		}
+
+		PfBenchmarkAddWork(junctions.ClosedCount(), 0, 0);
+		return best != nullptr ? best->m_origin : nullptr;
+	}
+
 public:
 	/**
 	 * Called by YAPF to move from the given node to the next tile. For each
@@ -436,6 +590,30 @@ public:
 		/* if path not found - return INVALID_TRACKDIR */
 		Trackdir next_trackdir = INVALID_TRACKDIR;
 		Node *pNode = Yapf().GetBestNode();
+
+		/* Out of nodes before reaching the destination? Then continue on the junction graph. */
+		uint factor = Yapf().PfGetSettings().rail_junction_search_factor;
+		if (!path_found && factor > 0 && Yapf().m_nodes.OpenCount() > 0) {
+			JunctionSearchMiss dest;
+			dest.owner = v->owner;
+			dest.railtypes = v->compatible_railtypes;
+			dest.station = v->current_order.IsType(OT_GOTO_STATION) || v->current_order.IsType(OT_GOTO_WAYPOINT) ? v->current_order.GetDestination() : INVALID_STATION;
+			dest.tile = dest.station == INVALID_STATION ? v->dest_tile : INVALID_TILE;
+
+			/* Did a junction search to this destination fail during these vehicle ticks already? Then do not repeat it. */
+			bool missed = std::find(_junction_search_misses.begin(), _junction_search_misses.end(), dest) != _junction_search_misses.end();
+			if (!missed) {
+				Node *via = FindPathOnJunctionGraph(Yapf().PfGetSettings().max_search_nodes * factor);
+				if (via != nullptr) {
+					pNode = via;
+					path_found = true;
+				} else if (_junction_search_misses_active && _pf_benchmark_work == nullptr) {
+					/* Replays of the path finder benchmark must not change the outcome of the game. */
+					_junction_search_misses.push_back(dest);
+				}
+			}
+		}
+
 		if (pNode != nullptr) {
 			/* reserve till end of path */
 			this->SetReservationTarget(pNode, pNode->GetLastTile(), pNode->GetLastTrackdir());
@@ -614,6 +792,13 @@ FindDepotData YapfTrainFindNearestDepot(const Train *v, int max_penalty)
 	TileIndex last_tile = last_veh->tile;
 	Trackdir td_rev = ReverseTrackdir(last_veh->GetVehicleTrackdir());
 
+	/* Every tile of a path costs at least YAPF_TILE_CORNER_LENGTH, so don't
+	 * search when no depot can be within the maximum penalty. */
+	if (max_penalty > 0) {
+		uint min_distance = min(GetDepotDistanceLowerBound(origin.tile, v->owner, TRANSPORT_RAIL), GetDepotDistanceLowerBound(last_tile, v->owner, TRANSPORT_RAIL));
+		if (min_distance > (uint)max_penalty / YAPF_TILE_CORNER_LENGTH) return FindDepotData();
+	}
+
 	typedef FindDepotData (*PfnFindNearestDepotTwoWay)(const Train*, TileIndex, Trackdir, TileIndex, Trackdir, int, int);
 	PfnFindNearestDepotTwoWay pfnFindNearestDepotTwoWay = &CYapfAnyDepotRail1::stFindNearestDepotTwoWay;
 
@@ -638,10 +823,39 @@ bool YapfTrainFindNearestSafeTile(const Train *v, TileIndex tile, Trackdir td, b
 	return pfnFindNearestSafeTile(v, tile, td, override_railtype);
 }
 
-/** if any track changes, this counter is incremented - that will invalidate segment cost cache */
-int CSegmentCostCacheBase::s_rail_change_counter = 0;
+/** if any track changes, this counter is incremented and the tile logged - that will invalidate the segment cost cache there */
+uint CSegmentCostCacheBase::s_rail_change_counter = 0;
+TileIndex CSegmentCostCacheBase::s_rail_change_log[CSegmentCostCacheBase::C_CHANGE_LOG_SIZE];
+uint64 CSegmentCostCacheBase::s_stats_hits = 0;
+uint64 CSegmentCostCacheBase::s_stats_misses = 0;
+uint64 CSegmentCostCacheBase::s_stats_invalidated = 0;
+uint64 CSegmentCostCacheBase::s_stats_flushes = 0;
 
 void YapfNotifyTrackLayoutChange(TileIndex tile, Track track)
 {
 	CSegmentCostCacheBase::NotifyTrackLayoutChange(tile, track);
+	/* reservations may be followed differently now, also past tiles they do not reserve */
+	InvalidateTrainReservationCache(INVALID_TILE);
+}
+
+/**
+ * Print the statistics of the rail segment cost caches to the console.
+ * @param reset Whether to reset the statistics afterwards.
+ */
+void ConPrintYapfCacheStats(bool reset)
+{
+	uint64 lookups = CSegmentCostCacheBase::s_stats_hits + CSegmentCostCacheBase::s_stats_misses;
+	IConsolePrintF(CC_DEFAULT, "Rail segment cost cache:");
+	IConsolePrintF(CC_DEFAULT, "  Hits:        " OTTD_PRINTF64 " (%u%%)", CSegmentCostCacheBase::s_stats_hits,
+			lookups == 0 ? 0 : (uint)(CSegmentCostCacheBase::s_stats_hits * 100 / lookups));
+	IConsolePrintF(CC_DEFAULT, "  Misses:      " OTTD_PRINTF64, CSegmentCostCacheBase::s_stats_misses);
+	IConsolePrintF(CC_DEFAULT, "  Invalidated: " OTTD_PRINTF64 " segments", CSegmentCostCacheBase::s_stats_invalidated);
+	IConsolePrintF(CC_DEFAULT, "  Flushed:     " OTTD_PRINTF64 " times", CSegmentCostCacheBase::s_stats_flushes);
+
+	if (reset) {
+		CSegmentCostCacheBase::s_stats_hits = 0;
+		CSegmentCostCacheBase::s_stats_misses = 0;
+		CSegmentCostCacheBase::s_stats_invalidated = 0;
+		CSegmentCostCacheBase::s_stats_flushes = 0;
+	}
 }
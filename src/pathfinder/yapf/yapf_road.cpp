@@ -13,6 +13,7 @@
 #include "yapf.hpp"
 #include "yapf_node_road.hpp"
 #include "../../roadstop_base.h"
+#include "../../depot_func.h"
 
 #include "../../safeguards.h"
 
@@ -408,6 +409,40 @@ public:
 		return next_trackdir;
 	}
 
+	static void stFindPathAhead(const RoadVehicle *v, RoadVehPathCache &ahead)
+	{
+		Tpf pf;
+		pf.FindPathAhead(v, ahead);
+	}
+
+	/**
+	 * Search the path of a road vehicle beyond the last choice of its cached path.
+	 * @param v The road vehicle.
+	 * @param ahead [out] Choices following the cached path.
+	 */
+	inline void FindPathAhead(const RoadVehicle *v, RoadVehPathCache &ahead)
+	{
+		assert(!v->path.empty());
+		TileIndex tile = v->path.tile.back();
+		if (tile == v->dest_tile) return;
+
+		Yapf().SetOrigin(tile, TrackdirToTrackdirBits(v->path.td.back()));
+		Yapf().SetDestination(v);
+		if (!Yapf().FindPath(v)) return;
+
+		/* Same as ChooseRoadTrack, with the origin being the last cached choice. */
+		Node *pNode = Yapf().GetBestNode();
+		uint steps = 0;
+		for (Node *n = pNode; n->m_parent != nullptr; n = n->m_parent) steps++;
+		for (; pNode->m_parent != nullptr; pNode = pNode->m_parent) {
+			steps--;
+			if (pNode->GetIsChoice() && steps < YAPF_ROADVEH_PATH_CACHE_SEGMENTS) {
+				ahead.td.push_front(pNode->GetTrackdir());
+				ahead.tile.push_front(pNode->GetTile());
+			}
+		}
+	}
+
 	static uint stDistanceToTile(const RoadVehicle *v, TileIndex tile)
 	{
 		Tpf pf;
@@ -525,6 +560,15 @@ Trackdir YapfRoadVehicleChooseTrack(const RoadVehicle *v, TileIndex tile, DiagDi
 	return (td_ret != INVALID_TRACKDIR) ? td_ret : (Trackdir)FindFirstBit2x64(trackdirs);
 }
 
+void YapfRoadVehicleFindPathAhead(const RoadVehicle *v, RoadVehPathCache &ahead)
+{
+	if (_settings_game.pf.yapf.disable_node_optimization) {
+		CYapfRoad1::stFindPathAhead(v, ahead);
+	} else {
+		CYapfRoad2::stFindPathAhead(v, ahead);
+	}
+}
+
 FindDepotData YapfRoadVehicleFindNearestDepot(const RoadVehicle *v, int max_distance)
 {
 	TileIndex tile = v->tile;
@@ -533,6 +577,12 @@ FindDepotData YapfRoadVehicleFindNearestDepot(const RoadVehicle *v, int max_dist
 		return FindDepotData();
 	}
 
+	/* Every tile of a path costs at least YAPF_TILE_CORNER_LENGTH, so don't
+	 * search when no depot can be within the maximum penalty. */
+	if (max_distance > 0 && GetDepotDistanceLowerBound(tile, v->owner, TRANSPORT_ROAD) > (uint)max_distance / YAPF_TILE_CORNER_LENGTH) {
+		return FindDepotData();
+	}
+
 	/* default is YAPF type 2 */
 	typedef FindDepotData (*PfnFindNearestDepot)(const RoadVehicle*, TileIndex, Trackdir, int);
 	PfnFindNearestDepot pfnFindNearestDepot = &CYapfRoadAnyDepot2::stFindNearestDepot;
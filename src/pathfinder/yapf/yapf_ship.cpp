@@ -199,6 +199,42 @@ public:
 		return next_trackdir;
 	}
 
+	/**
+	 * Search the path of a ship beyond the end of its cached path.
+	 * @param v Ship
+	 * @param tile Tile the first step of the cached path follows.
+	 * @param td Trackdir the first step of the cached path follows.
+	 * @param ahead [out] Steps following the cached path.
+	 */
+	static void FindShipPathAhead(const Ship *v, TileIndex tile, Trackdir td, ShipPathCache &ahead)
+	{
+		/* Walk to the end of the cached path. */
+		TrackFollower F(v);
+		for (Trackdir step : v->path) {
+			if (!F.Follow(tile, td) || !HasTrackdir(F.m_new_td_bits, step)) return;
+			tile = F.m_new_tile;
+			td = step;
+		}
+		if (tile == v->dest_tile) return;
+
+		Tpf pf;
+		pf.SetOrigin(tile, TrackdirToTrackdirBits(td));
+		pf.SetDestination(v);
+		if (!pf.FindPath(v)) return;
+
+		/* Same as ChooseShipTrack, except that the first step is not taken right away. */
+		Node *pNode = pf.GetBestNode();
+		uint steps = 0;
+		for (Node *n = pNode; n->m_parent != nullptr; n = n->m_parent) steps++;
+		uint skip = YAPF_SHIP_PATH_CACHE_LENGTH / 2;
+		for (; pNode->m_parent != nullptr; pNode = pNode->m_parent) {
+			steps--;
+			if (skip > 0) skip--;
+			if (skip == 0 && steps < YAPF_SHIP_PATH_CACHE_LENGTH) ahead.push_front(pNode->GetTrackdir());
+		}
+		if (!ahead.empty()) ahead.pop_back();
+	}
+
 	/**
 	 * Check whether a ship should reverse to reach its destination.
 	 * Called when leaving depot.
@@ -365,6 +401,15 @@ Track YapfShipChooseTrack(const Ship *v, TileIndex tile, DiagDirection enterdir,
 	return (td_ret != INVALID_TRACKDIR) ? TrackdirToTrack(td_ret) : INVALID_TRACK;
 }
 
+void YapfShipFindPathAhead(const Ship *v, TileIndex tile, Trackdir td, ShipPathCache &ahead)
+{
+	if (_settings_game.pf.yapf.disable_node_optimization || RequireTrackdirKey()) {
+		CYapfShip1::FindShipPathAhead(v, tile, td, ahead);
+	} else {
+		CYapfShip2::FindShipPathAhead(v, tile, td, ahead);
+	}
+}
+
 bool YapfShipCheckReverse(const Ship *v)
 {
 	Trackdir td = v->GetVehicleTrackdir();
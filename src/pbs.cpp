@@ -14,9 +14,75 @@
 #include "vehicle_func.h"
 #include "newgrf_station.h"
 #include "pathfinder/follow_track.hpp"
+#include "debug.h"
+#include "console_func.h"
+#include <unordered_map>
+#include <vector>
 
 #include "safeguards.h"
 
+/**
+ * Reservation of a train, as found the last time it was followed.
+ * Following it again from any of its tiles ends at the same tile as long as
+ * the reservations of that tile and of the tiles after it are the same.
+ */
+struct CachedTrainReservation {
+	Owner owner;                   ///< Owner of the train.
+	RailTypes rts;                 ///< Rail types the train can run on.
+	std::vector<PBSTileInfo> path; ///< The reserved tiles and trackdirs from where the reservation was followed to its end.
+	std::vector<TileIndex> beyond; ///< Tiles after the end of the reservation whose reservations ended it.
+	std::vector<TrackBits> reserved; ///< Reserved tracks of the tiles in #path and then of those in #beyond when the reservation was followed.
+	PBSTileInfo end;               ///< End of the reservation.
+	bool loop;                     ///< Whether the reservation ended because it returned to its start.
+	int changed;                   ///< Highest index in #path of a tile whose reservation was written since, -1 if none; tiles in #beyond count as the size of #path.
+
+	CachedTrainReservation() : owner(INVALID_OWNER), rts(RAILTYPES_NONE), loop(false), changed(-1) {}
+};
+
+static std::vector<CachedTrainReservation> _train_reservation_cache; ///< Reservations of the trains, by vehicle index.
+static std::unordered_multimap<TileIndex, std::pair<VehicleID, int> > _train_reservation_tiles; ///< Trains whose cached reservation depends on a tile, with the index of the tile in their path.
+static uint64 _train_reservation_cache_hits = 0;   ///< Number of reservation ends taken from the cache.
+static uint64 _train_reservation_cache_misses = 0; ///< Number of reservations that had to be followed.
+
+/**
+ * Tell the cached train reservations that the reservation of a tile was written.
+ * Only the trains whose cached reservation passes or ends at the tile are affected.
+ * @param tile The tile, or \c INVALID_TILE to forget all cached reservations, e.g. because the track layout changed.
+ */
+void InvalidateTrainReservationCache(TileIndex tile)
+{
+	if (tile == INVALID_TILE) {
+		_train_reservation_cache.clear();
+		_train_reservation_tiles.clear();
+		return;
+	}
+
+	auto range = _train_reservation_tiles.equal_range(tile);
+	for (auto it = range.first; it != range.second; ++it) {
+		CachedTrainReservation &cache = _train_reservation_cache[it->second.first];
+		cache.changed = max(cache.changed, it->second.second);
+	}
+}
+
+/**
+ * Print the statistics of the train reservation cache to the console.
+ * @param reset Whether to reset the statistics afterwards.
+ */
+void ConPrintTrainReservationCacheStats(bool reset)
+{
+	uint64 lookups = _train_reservation_cache_hits + _train_reservation_cache_misses;
+	IConsolePrintF(CC_DEFAULT, "Train reservation cache:");
+	IConsolePrintF(CC_DEFAULT, "  Hits:        " OTTD_PRINTF64 " (%u%%)", _train_reservation_cache_hits,
+			lookups == 0 ? 0 : (uint)(_train_reservation_cache_hits * 100 / lookups));
+	IConsolePrintF(CC_DEFAULT, "  Misses:      " OTTD_PRINTF64, _train_reservation_cache_misses);
+	IConsolePrintF(CC_DEFAULT, "  Watched:     %u tiles", (uint)_train_reservation_tiles.size());
+
+	if (reset) {
+		_train_reservation_cache_hits = 0;
+		_train_reservation_cache_misses = 0;
+	}
+}
+
 /**
  * Get the reserved trackbits for any tile, regardless of type.
  * @param t the tile
@@ -186,13 +252,18 @@ void UnreserveRailTrack(TileIndex tile, Track t)
 }
 
 
-/** Follow a reservation starting from a specific tile to the end. */
-static PBSTileInfo FollowReservation(Owner o, RailTypes rts, TileIndex tile, Trackdir trackdir, bool ignore_oneway = false)
+/**
+ * Follow a reservation starting from a specific tile to the end.
+ * @param trace If not \c nullptr, gets the tiles of the reservation and the tiles whose reservation ended it.
+ */
+static PBSTileInfo FollowReservation(Owner o, RailTypes rts, TileIndex tile, Trackdir trackdir, bool ignore_oneway = false, CachedTrainReservation *trace = nullptr)
 {
 	TileIndex start_tile = tile;
 	Trackdir  start_trackdir = trackdir;
 	bool      first_loop = true;
 
+	if (trace != nullptr) trace->path.emplace_back(tile, trackdir, false);
+
 	/* Start track not reserved? This can happen if two trains
 	 * are on the same tile. The reservation on the next tile
 	 * is not ours in this case, so exit. */
@@ -205,6 +276,7 @@ static PBSTileInfo FollowReservation(Owner o, RailTypes rts, TileIndex tile, Tra
 
 		/* No reservation --> path end found */
 		if (reserved == TRACKDIR_BIT_NONE) {
+			if (trace != nullptr) trace->beyond.push_back(ft.m_new_tile);
 			if (ft.m_is_station) {
 				/* Check skipped station tiles as well, maybe our reservation ends inside the station. */
 				TileIndexDiff diff = TileOffsByDiagDir(ft.m_exitdir);
@@ -213,8 +285,10 @@ static PBSTileInfo FollowReservation(Owner o, RailTypes rts, TileIndex tile, Tra
 					if (HasStationReservation(ft.m_new_tile)) {
 						tile = ft.m_new_tile;
 						trackdir = DiagDirToDiagTrackdir(ft.m_exitdir);
+						if (trace != nullptr) trace->path.emplace_back(tile, trackdir, false);
 						break;
 					}
+					if (trace != nullptr) trace->beyond.push_back(ft.m_new_tile);
 				}
 			}
 			break;
@@ -225,7 +299,10 @@ static PBSTileInfo FollowReservation(Owner o, RailTypes rts, TileIndex tile, Tra
 
 		/* One-way signal against us. The reservation can't be ours as it is not
 		 * a safe position from our direction and we can never pass the signal. */
-		if (!ignore_oneway && HasOnewaySignalBlockingTrackdir(ft.m_new_tile, new_trackdir)) break;
+		if (!ignore_oneway && HasOnewaySignalBlockingTrackdir(ft.m_new_tile, new_trackdir)) {
+			if (trace != nullptr) trace->beyond.push_back(ft.m_new_tile);
+			break;
+		}
 
 		tile = ft.m_new_tile;
 		trackdir = new_trackdir;
@@ -240,8 +317,12 @@ static PBSTileInfo FollowReservation(Owner o, RailTypes rts, TileIndex tile, Tra
 			first_loop = false;
 		} else {
 			/* Loop encountered? */
-			if (tile == start_tile && trackdir == start_trackdir) break;
+			if (tile == start_tile && trackdir == start_trackdir) {
+				if (trace != nullptr) trace->loop = true;
+				break;
+			}
 		}
+		if (trace != nullptr) trace->path.emplace_back(tile, trackdir, false);
 		/* Depot tile? Can't continue. */
 		if (IsRailDepotTile(tile)) break;
 		/* Non-pbs signal? Reservation can't continue. */
@@ -281,6 +362,99 @@ static Vehicle *FindTrainOnTrackEnum(Vehicle *v, void *data)
 	return nullptr;
 }
 
+/**
+ * Check whether the tiles of a cached reservation are still reserved as when it was followed.
+ * Trains often reserve a tile and free it again, e.g. when they fail to find a path.
+ * @param cache The cached reservation.
+ * @param first Index in the path of the first tile to check; the tiles before it are not checked.
+ * @return True if the reservations of the tiles from  first on did not change.
+ */
+static bool IsCachedReservationUnchanged(const CachedTrainReservation &cache, size_t first)
+{
+	for (size_t i = first; i < cache.path.size(); i++) {
+		if (GetReservedTrackbits(cache.path[i].tile) != cache.reserved[i]) return false;
+	}
+	for (size_t i = 0; i < cache.beyond.size(); i++) {
+		if (GetReservedTrackbits(cache.beyond[i]) != cache.reserved[cache.path.size() + i]) return false;
+	}
+	return true;
+}
+
+/**
+ * Find the end of the reservation of a train. The trains may need the end
+ * of their reservation several times before it changes, also after moving
+ * along it, so the reservation is cached per train. It stays valid for a
+ * tile of it as long as the reservations of that tile and of the tiles
+ * after it are the same.
+ *
+ * @param v the vehicle
+ * @param tile the tile the vehicle is on
+ * @param trackdir the trackdir the vehicle is on
+ * @return The last tile of the reservation.
+ */
+static PBSTileInfo FollowTrainReservationEnd(const Train *v, TileIndex tile, Trackdir trackdir)
+{
+	RailTypes rts = GetRailTypeInfo(v->railtype)->compatible_railtypes;
+
+	if (v->index >= _train_reservation_cache.size()) _train_reservation_cache.resize(v->index + 1);
+	CachedTrainReservation &cache = _train_reservation_cache[v->index];
+
+	bool valid = false;
+	if (cache.owner == v->owner && cache.rts == rts) {
+		/* Only the tiles from the current one on matter; the tiles the train left behind do not. */
+		int last = cache.loop ? 0 : (int)cache.path.size() - 1;
+		for (int i = 0; i <= last; i++) {
+			if (cache.path[i].tile != tile || cache.path[i].trackdir != trackdir) continue;
+			if (i <= cache.changed) {
+				if (!IsCachedReservationUnchanged(cache, i)) break;
+				cache.changed = i - 1;
+			}
+			valid = true;
+			break;
+		}
+	}
+	if (valid) {
+		_train_reservation_cache_hits++;
+		if (_debug_desync_level < 2) return cache.end;
+	} else {
+		_train_reservation_cache_misses++;
+	}
+
+	/* Stop watching the tiles of the old reservation. */
+	auto unwatch = [v](TileIndex t) {
+		auto range = _train_reservation_tiles.equal_range(t);
+		for (auto it = range.first; it != range.second;) {
+			it = (it->second.first == v->index) ? _train_reservation_tiles.erase(it) : std::next(it);
+		}
+	};
+	for (const PBSTileInfo &pos : cache.path) unwatch(pos.tile);
+	for (TileIndex t : cache.beyond) unwatch(t);
+
+	PBSTileInfo cached_end = cache.end;
+	cache.owner = v->owner;
+	cache.rts = rts;
+	cache.path.clear();
+	cache.beyond.clear();
+	cache.reserved.clear();
+	cache.loop = false;
+	cache.changed = -1;
+	PBSTileInfo end = FollowReservation(v->owner, rts, tile, trackdir, false, &cache);
+	cache.end = end;
+	if (valid && (end.tile != cached_end.tile || end.trackdir != cached_end.trackdir)) {
+		DEBUG(desync, 2, "reservation cache mismatch: train %d, cached end 0x%x, actual end 0x%x", v->index, cached_end.tile, end.tile);
+	}
+
+	for (int i = 0; i < (int)cache.path.size(); i++) {
+		_train_reservation_tiles.emplace(cache.path[i].tile, std::make_pair(v->index, i));
+		cache.reserved.push_back(GetReservedTrackbits(cache.path[i].tile));
+	}
+	for (TileIndex t : cache.beyond) {
+		_train_reservation_tiles.emplace(t, std::make_pair(v->index, (int)cache.path.size()));
+		cache.reserved.push_back(GetReservedTrackbits(t));
+	}
+	return end;
+}
+
 /**
  * Follow a train reservation to the last tile.
  *
@@ -298,7 +472,7 @@ PBSTileInfo FollowTrainReservation(const Train *v, Vehicle **train_on_res)
 	if (IsRailDepotTile(tile) && !GetDepotReservationTrackBits(tile)) return PBSTileInfo(tile, trackdir, false);
 
 	FindTrainOnTrackInfo ftoti;
-	ftoti.res = FollowReservation(v->owner, GetRailTypeInfo(v->railtype)->compatible_railtypes, tile, trackdir);
+	ftoti.res = FollowTrainReservationEnd(v, tile, trackdir);
 	ftoti.res.okay = IsSafeWaitingPosition(v, ftoti.res.tile, ftoti.res.trackdir, true, _settings_game.pf.forbid_90_deg);
 	if (train_on_res != nullptr) {
 		FindVehicleOnPos(ftoti.res.tile, &ftoti, FindTrainOnTrackEnum);
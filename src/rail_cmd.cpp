@@ -33,6 +33,7 @@
 #include "strings_func.h"
 #include "company_gui.h"
 #include "object_map.h"
+#include "depot_func.h"
 
 #include "table/strings.h"
 #include "table/railtypes.h"
@@ -1014,6 +1015,7 @@ CommandCost CmdBuildTrainDepot(TileIndex tile, DoCommandFlag flags, uint32 p1, u
 		MakeRailDepot(tile, _current_company, d->index, dir, railtype);
 		MarkTileDirtyByTile(tile);
 		MakeDefaultName(d);
+		AddDepotToDistanceField(tile);
 
 		Company::Get(_current_company)->infrastructure.rail[railtype]++;
 		DirtyCompanyInfrastructureWindows(_current_company);
@@ -3058,6 +3060,10 @@ static CommandCost TerraformTile_Track(TileIndex tile, DoCommandFlag flags, int
 {
 	int z_old;
 	Slope tileh_old = GetTileSlope(tile, &z_old);
+
+	/* The slope of the tile is part of the cost of its track. */
+	if (flags & DC_EXEC) YapfNotifyTrackLayoutChange(tile, INVALID_TRACK);
+
 	if (IsPlainRail(tile)) {
 		TrackBits rail_bits = GetTrackBits(tile);
 		/* Is there flat water on the lower halftile that must be cleared expensively? */
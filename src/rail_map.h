@@ -216,6 +216,7 @@ static inline void SetTrackReservation(TileIndex t, TrackBits b)
 	Track track = RemoveFirstTrack(&b);
 	SB(_m[t].m2, 8, 3, track == INVALID_TRACK ? 0 : track + 1);
 	SB(_m[t].m2, 11, 1, (byte)(b != TRACK_BIT_NONE));
+	InvalidateTrainReservationCache(t);
 }
 
 /**
@@ -273,6 +274,7 @@ static inline void SetDepotReservation(TileIndex t, bool b)
 {
 	assert(IsRailDepot(t));
 	SB(_m[t].m5, 4, 1, (byte)b);
+	InvalidateTrainReservationCache(t);
 }
 
 /**
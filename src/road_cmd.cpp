@@ -39,6 +39,8 @@
 #include "genworld.h"
 #include "company_gui.h"
 #include "road_func.h"
+#include "depot_func.h"
+#include "signal_func.h"
 
 #include "table/strings.h"
 #include "table/roadtypes.h"
@@ -528,6 +530,7 @@ static CommandCost RemoveRoad(TileIndex tile, DoCommandFlag flags, RoadBits piec
 				}
 				MarkTileDirtyByTile(tile);
 				YapfNotifyTrackLayoutChange(tile, railtrack);
+				InvalidateSignalSegmentCache();
 			}
 			return CommandCost(EXPENSES_CONSTRUCTION, RoadClearCost(existing_rt) * 2);
 		}
@@ -775,6 +778,7 @@ CommandCost CmdBuildRoad(TileIndex tile, DoCommandFlag flags, uint32 p1, uint32
 			if (flags & DC_EXEC) {
 				Track railtrack = AxisToTrack(OtherAxis(roaddir));
 				YapfNotifyTrackLayoutChange(tile, railtrack);
+				InvalidateSignalSegmentCache();
 				/* Update company infrastructure counts. A level crossing has two road bits. */
 				UpdateCompanyRoadInfrastructure(rt, company, 2);
 
@@ -1202,6 +1206,7 @@ CommandCost CmdBuildRoadDepot(TileIndex tile, DoCommandFlag flags, uint32 p1, ui
 		MakeRoadDepot(tile, _current_company, dep->index, dir, rt);
 		MarkTileDirtyByTile(tile);
 		MakeDefaultName(dep);
+		AddDepotToDistanceField(tile);
 	}
 	cost.AddCost(_price[PR_BUILD_DEPOT_ROAD]);
 	return cost;
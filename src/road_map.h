@@ -396,6 +396,7 @@ static inline void SetCrossingReservation(TileIndex t, bool b)
 {
 	assert(IsLevelCrossingTile(t));
 	SB(_m[t].m5, 4, 1, b ? 1 : 0);
+	InvalidateTrainReservationCache(t);
 }
 
 /**
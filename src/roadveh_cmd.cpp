@@ -19,6 +19,7 @@
 #include "articulated_vehicles.h"
 #include "newgrf_sound.h"
 #include "pathfinder/yapf/yapf.h"
+#include "pathfinder/pf_benchmark.h"
 #include "strings_func.h"
 #include "tunnelbridge_map.h"
 #include "date_func.h"
@@ -617,10 +618,14 @@ struct RoadVehFindData {
 	Direction dir;
 };
 
+/* Distance in front of a road vehicle, per direction, in which another road vehicle blocks it. */
+static const int8 _road_veh_close_dist_x[] = { -4, -8, -4, -1, 4, 8, 4, 1 };
+static const int8 _road_veh_close_dist_y[] = { -4, -1, 4, 8, 4, 1, -4, -8 };
+
 static Vehicle *EnumCheckRoadVehClose(Vehicle *v, void *data)
 {
-	static const int8 dist_x[] = { -4, -8, -4, -1, 4, 8, 4, 1 };
-	static const int8 dist_y[] = { -4, -1, 4, 8, 4, 1, -4, -8 };
+	const int8 *dist_x = _road_veh_close_dist_x;
+	const int8 *dist_y = _road_veh_close_dist_y;
 
 	RoadVehFindData *rvf = (RoadVehFindData*)data;
 
@@ -647,6 +652,42 @@ static Vehicle *EnumCheckRoadVehClose(Vehicle *v, void *data)
 	return nullptr;
 }
 
+/**
+ * Check a list of road vehicles like EnumCheckRoadVehClose does.
+ * Only road vehicles driving in the searched direction can block, so the
+ * distance window is the same for all of them and checked as two ranges.
+ */
+static void EnumCheckRoadVehsClose(Vehicle * const *vehicles, size_t count, void *data)
+{
+	RoadVehFindData *rvf = (RoadVehFindData*)data;
+
+	/* x_diff has to be in (dist_x, 0] for negative and in [0, dist_x) for positive distances, likewise for y. */
+	int dist_x = _road_veh_close_dist_x[rvf->dir];
+	int dist_y = _road_veh_close_dist_y[rvf->dir];
+	int x_min = dist_x < 0 ? dist_x + 1 : 0;
+	int y_min = dist_y < 0 ? dist_y + 1 : 0;
+	uint x_range = abs(dist_x) - 1;
+	uint y_range = abs(dist_y) - 1;
+
+	for (size_t i = 0; i < count; i++) {
+		Vehicle *v = vehicles[i];
+		if (v->direction != rvf->dir) continue;
+
+		short x_diff = v->x_pos - rvf->x;
+		short y_diff = v->y_pos - rvf->y;
+		if ((uint)(x_diff - x_min) > x_range || (uint)(y_diff - y_min) > y_range) continue;
+
+		if (v->IsInDepot() || abs(v->z_pos - rvf->veh->z_pos) >= 6 || rvf->veh->First() == v->First()) continue;
+
+		uint diff = abs(x_diff) + abs(y_diff);
+
+		if (diff < rvf->best_diff || (diff == rvf->best_diff && v->index < rvf->best->index)) {
+			rvf->best = v;
+			rvf->best_diff = diff;
+		}
+	}
+}
+
 static RoadVehicle *RoadVehFindCloseTo(RoadVehicle *v, int x, int y, Direction dir, bool update_blocked_ctr = true)
 {
 	RoadVehFindData rvf;
@@ -664,7 +705,7 @@ static RoadVehicle *RoadVehFindCloseTo(RoadVehicle *v, int x, int y, Direction d
 		FindVehicleOnPos(v->tile, &rvf, EnumCheckRoadVehClose);
 		FindVehicleOnPos(GetOtherTunnelBridgeEnd(v->tile), &rvf, EnumCheckRoadVehClose);
 	} else {
-		FindVehicleOnPosXY(x, y, &rvf, EnumCheckRoadVehClose);
+		FindRoadVehiclesOnPosXY(x, y, &rvf, EnumCheckRoadVehsClose);
 	}
 
 	/* This code protects a roadvehicle from being blocked for ever
@@ -978,6 +1019,7 @@ static Trackdir RoadFindPathToDest(RoadVehicle *v, TileIndex tile, DiagDirection
 			if (HasBit(trackdirs, trackdir)) {
 				v->path.td.pop_front();
 				v->path.tile.pop_front();
+				if (_settings_game.pf.path_prefetch && v->path.size() == YAPF_ROADVEH_PATH_PREFETCH_SEGMENTS) RequestPathPrefetch(v, tile, trackdir);
 				return_track(trackdir);
 			}
 
@@ -986,6 +1028,8 @@ static Trackdir RoadFindPathToDest(RoadVehicle *v, TileIndex tile, DiagDirection
 		}
 	}
 
+	if (_pf_benchmark_active) PfBenchmarkHandleQuery(v, tile, enterdir, trackdirs);
+
 	switch (_settings_game.pf.pathfinder_for_roadvehs) {
 		case VPF_NPF:  best_track = NPFRoadVehicleChooseTrack(v, tile, enterdir, path_found); break;
 		case VPF_YAPF: best_track = YapfRoadVehicleChooseTrack(v, tile, enterdir, trackdirs, path_found, v->path); break;
@@ -58,6 +58,7 @@
 #include "../disaster_vehicle.h"
 #include "../ship.h"
 #include "../water.h"
+#include "../signal_func.h"
 
 
 #include "saveload_internal.h"
@@ -1413,6 +1414,7 @@ bool AfterLoadGame()
 	}
 
 	YapfNotifyTrackLayoutChange(INVALID_TILE, INVALID_TRACK);
+	InvalidateSignalSegmentCache();
 
 	if (IsSavegameVersionBefore(SLV_34)) {
 		Company *c;
@@ -116,8 +116,11 @@ const SaveLoad *GetCargoPacketDesc()
  */
 static void Save_CAPA()
 {
-	CargoPacket *cp;
+	/* The packets in vehicles are saved with their actual age. */
+	Vehicle *v;
+	FOR_ALL_VEHICLES(v) v->cargo.ApplyPendingAge();
 
+	CargoPacket *cp;
 	FOR_ALL_CARGOPACKETS(cp) {
 		SlSetArrayIndex(cp->index);
 		SlObject(cp, GetCargoPacketDesc());
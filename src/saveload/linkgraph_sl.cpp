@@ -24,6 +24,7 @@ typedef LinkGraph::BaseEdge Edge;
 const SettingDesc *GetSettingDescription(uint index);
 
 static uint16 _num_nodes;
+static NodeID _next_edge; ///< Destination of the next edge of a node in the savegame.
 
 /**
  * Get a SaveLoad array for a link graph.
@@ -126,15 +127,40 @@ static const SaveLoad _edge_desc[] = {
 	     SLE_VAR(Edge, usage,                    SLE_UINT32),
 	     SLE_VAR(Edge, last_unrestricted_update, SLE_INT32),
 	 SLE_CONDVAR(Edge, last_restricted_update,   SLE_INT32, SLV_187, SL_MAX_VERSION),
-	     SLE_VAR(Edge, next_edge,                SLE_UINT16),
+	    SLEG_VAR(_next_edge,                     SLE_UINT16),
 	     SLE_END()
 };
 
 /**
- * Save/load a link graph.
- * @param lg Link graph to be saved or loaded.
+ * Save a link graph.
+ * Savegames store the edges of a node as a list linked by the destination of
+ * the next edge, starting at an edge from the node to itself which only holds
+ * the destination of the first real edge.
+ * @param lg Link graph to be saved.
+ */
+void Save_LinkGraph(LinkGraph &lg)
+{
+	Edge start;
+	for (NodeID from = 0; from < lg.Size(); ++from) {
+		Node *node = &lg.nodes[from];
+		SlObject(node, _node_desc);
+
+		start.Init(from);
+		_next_edge = node->edges.empty() ? INVALID_NODE : node->edges.front().dest_node;
+		SlObject(&start, _edge_desc);
+		for (auto it = node->edges.begin(); it != node->edges.end(); ++it) {
+			_next_edge = (it + 1 == node->edges.end()) ? INVALID_NODE : (it + 1)->dest_node;
+			SlObject(&*it, _edge_desc);
+		}
+	}
+}
+
+/**
+ * Load a link graph.
+ * @param lg Link graph to be loaded.
+ * @see Save_LinkGraph for the layout of the edges.
  */
-void SaveLoad_LinkGraph(LinkGraph &lg)
+void Load_LinkGraph(LinkGraph &lg)
 {
 	uint size = lg.Size();
 	for (NodeID from = 0; from < size; ++from) {
@@ -142,13 +168,24 @@ void SaveLoad_LinkGraph(LinkGraph &lg)
 		SlObject(node, _node_desc);
 		if (IsSavegameVersionBefore(SLV_191)) {
 			/* We used to save the full matrix ... */
+			LinkGraph::EdgeVector row(size);
+			std::vector<NodeID> next(size);
 			for (NodeID to = 0; to < size; ++to) {
-				SlObject(&lg.edges[from][to], _edge_desc);
+				SlObject(&row[to], _edge_desc);
+				row[to].dest_node = to;
+				next[to] = _next_edge;
+			}
+			for (NodeID to = next[from]; to != INVALID_NODE; to = next[to]) {
+				node->edges.push_back(row[to]);
 			}
 		} else {
 			/* ... but as that wasted a lot of space we save a sparse matrix now. */
-			for (NodeID to = from; to != INVALID_NODE; to = lg.edges[from][to].next_edge) {
-				SlObject(&lg.edges[from][to], _edge_desc);
+			Edge edge;
+			for (NodeID to = from; to != INVALID_NODE; to = _next_edge) {
+				SlObject(&edge, _edge_desc);
+				if (to == from) continue;
+				edge.dest_node = to;
+				node->edges.push_back(edge);
 			}
 		}
 	}
@@ -163,7 +200,7 @@ static void DoSave_LGRJ(LinkGraphJob *lgj)
 	SlObject(lgj, GetLinkGraphJobDesc());
 	_num_nodes = lgj->Size();
 	SlObject(const_cast<LinkGraph *>(&lgj->Graph()), GetLinkGraphDesc());
-	SaveLoad_LinkGraph(const_cast<LinkGraph &>(lgj->Graph()));
+	Save_LinkGraph(const_cast<LinkGraph &>(lgj->Graph()));
 }
 
 /**
@@ -174,7 +211,7 @@ static void DoSave_LGRP(LinkGraph *lg)
 {
 	_num_nodes = lg->Size();
 	SlObject(lg, GetLinkGraphDesc());
-	SaveLoad_LinkGraph(*lg);
+	Save_LinkGraph(*lg);
 }
 
 /**
@@ -191,7 +228,7 @@ static void Load_LGRP()
 		LinkGraph *lg = new (index) LinkGraph();
 		SlObject(lg, GetLinkGraphDesc());
 		lg->Init(_num_nodes);
-		SaveLoad_LinkGraph(*lg);
+		Load_LinkGraph(*lg);
 	}
 }
 
@@ -211,7 +248,7 @@ static void Load_LGRJ()
 		LinkGraph &lg = const_cast<LinkGraph &>(lgj->Graph());
 		SlObject(&lg, GetLinkGraphDesc());
 		lg.Init(_num_nodes);
-		SaveLoad_LinkGraph(lg);
+		Load_LinkGraph(lg);
 	}
 }
 
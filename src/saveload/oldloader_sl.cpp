@@ -49,7 +49,13 @@ void FixOldMapArray()
 {
 	/* TTO/TTD/TTDP savegames could have buoys at tile 0
 	 * (without assigned station struct) */
-	MemSetT(&_m[0], 0);
+	_m[0].type = 0;
+	_m[0].height = 0;
+	_m[0].m1 = 0;
+	_m[0].m2 = 0;
+	_m[0].m3 = 0;
+	_m[0].m4 = 0;
+	_m[0].m5 = 0;
 	SetTileType(0, MP_WATER);
 	SetTileOwner(0, OWNER_WATER);
 }
@@ -1475,8 +1481,21 @@ static bool LoadOldGameDifficulty(LoadgameState *ls, int num)
 static bool LoadOldMapPart1(LoadgameState *ls, int num)
 {
 	if (_savegame_type == SGT_TTO) {
+#ifdef WITH_MAP_PLANES
+		MemSetT(_m.type, 0, OLD_MAP_SIZE);
+		MemSetT(_m.height, 0, OLD_MAP_SIZE);
+		MemSetT(_m.m2, 0, OLD_MAP_SIZE);
+		MemSetT(_m.m1, 0, OLD_MAP_SIZE);
+		MemSetT(_m.m3, 0, OLD_MAP_SIZE);
+		MemSetT(_m.m4, 0, OLD_MAP_SIZE);
+		MemSetT(_m.m5, 0, OLD_MAP_SIZE);
+		MemSetT(_me.m6, 0, OLD_MAP_SIZE);
+		MemSetT(_me.m7, 0, OLD_MAP_SIZE);
+		MemSetT(_me.m8, 0, OLD_MAP_SIZE);
+#else
 		MemSetT(_m, 0, OLD_MAP_SIZE);
 		MemSetT(_me, 0, OLD_MAP_SIZE);
+#endif /* WITH_MAP_PLANES */
 	}
 
 	for (uint i = 0; i < OLD_MAP_SIZE; i++) {
@@ -45,7 +45,13 @@
 #include "../string_func.h"
 #include "../fios.h"
 #include "../error.h"
+#include "../worker_thread.h"
 #include <atomic>
+#ifdef UNIX
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 #include "table/strings.h"
 
@@ -317,6 +323,15 @@ static void SlNullPointers()
 	assert(_sl.action == SLA_NULL);
 }
 
+/** Error of a savegame decompression that is not part of the save or load of the game; see #DecompressSavegame. */
+struct DecompressError {
+	StringID str;          ///< The translatable error message.
+	std::string extra_msg; ///< The extra error message coming from one of the APIs.
+};
+
+/** Error of the decompression running on this thread, if any; #SlError must then leave #_sl alone. */
+static thread_local DecompressError *_decompress_error = nullptr;
+
 /**
  * Error handler. Sets everything up to show an error message and to clean
  * up the mess of a partial savegame load.
@@ -327,6 +342,12 @@ static void SlNullPointers()
  */
 void NORETURN SlError(StringID string, const char *extra_msg)
 {
+	if (_decompress_error != nullptr) {
+		_decompress_error->str = string;
+		_decompress_error->extra_msg = (extra_msg == nullptr) ? "" : extra_msg;
+		throw std::exception();
+	}
+
 	/* Distinguish between loading into _load_check_data vs. normal save/load. */
 	if (_sl.action == SLA_LOAD_CHECK) {
 		_load_check_data.error = string;
@@ -394,11 +415,58 @@ static void SetAsyncSaveFinish(AsyncSaveFinishProc proc)
 	_async_save_finish.store(proc, std::memory_order_release);
 }
 
+#ifdef UNIX
+static pid_t _save_child = -1; ///< Forked copy of the game that is writing an autosave, or -1.
+static dev_t _save_child_dev;  ///< Device of the file the forked copy is writing.
+static ino_t _save_child_ino;  ///< Inode of the file the forked copy is writing.
+
+/**
+ * Handle the end of the forked copy of the game that wrote an autosave.
+ * @param status Exit status of the child as returned by waitpid.
+ */
+static void ForkedSaveFinished(int status)
+{
+	_save_child = -1;
+	InvalidateWindowData(WC_STATUS_BAR, 0, SBI_SAVELOAD_FINISH);
+
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		DEBUG(sl, 0, "Background autosave failed");
+		ShowErrorMessage(STR_ERROR_AUTOSAVE_FAILED, INVALID_STRING_ID, WL_ERROR);
+	}
+}
+
+/**
+ * Check, without waiting, whether the forked copy of the game is still writing an autosave.
+ * @return True if it is still busy.
+ */
+static bool PollForkedSave()
+{
+	int status;
+	if (_save_child != -1 && waitpid(_save_child, &status, WNOHANG) == _save_child) ForkedSaveFinished(status);
+	return _save_child != -1;
+}
+
+/**
+ * Check whether a file is the one the forked copy of the game is still writing.
+ * @param fh The file.
+ * @return True if the autosave in that file is not finished yet.
+ */
+static bool IsForkedSaveFile(FILE *fh)
+{
+	struct stat st;
+	return PollForkedSave() && fstat(fileno(fh), &st) == 0 && st.st_dev == _save_child_dev && st.st_ino == _save_child_ino;
+}
+#endif /* UNIX */
+
 /**
  * Handle async save finishes.
  */
 void ProcessAsyncSaveFinish()
 {
+#ifdef UNIX
+	PollForkedSave();
+#endif /* UNIX */
+
 	AsyncSaveFinishProc proc = _async_save_finish.exchange(nullptr, std::memory_order_acq_rel);
 	if (proc == nullptr) return;
 
@@ -2271,8 +2339,321 @@ struct LZMASaveFilter : SaveFilter {
 	}
 };
 
+/*
+ * The LZMA block format splits the savegame into blocks of at most
+ * LZMA_BLOCK_SIZE bytes that are compressed independently of each other,
+ * so both compressing and decompressing can be spread over the worker
+ * threads. Every block is preceded by its uncompressed and compressed size,
+ * both as big endian uint32, and a block with an uncompressed size of 0
+ * ends the savegame.
+ */
+static const size_t LZMA_BLOCK_SIZE = 1024 * 1024; ///< Maximum uncompressed size of a block.
+
+/** One block of the LZMA block format. */
+struct LZMABlock {
+	std::vector<byte> data;       ///< Uncompressed contents of the block.
+	std::vector<byte> compressed; ///< Compressed contents of the block.
+	bool ok;                      ///< Whether (de)compressing the block succeeded.
+};
+
+/**
+ * Get the number of blocks to (de)compress at once.
+ * @return The number of blocks.
+ */
+static size_t GetLZMABlockBatchSize()
+{
+	/* Give every thread a few blocks, so one slow block does not leave the others idle. */
+	return GetWorkerThreadCount() * 4;
+}
+
+/** Filter decompressing the LZMA block format on the worker threads. */
+struct LZMABlockLoadFilter : LoadFilter {
+	std::vector<LZMABlock> blocks; ///< The blocks of the current batch.
+	size_t block;                  ///< Block of the batch we are reading from.
+	size_t pos;                    ///< Position in the block we are reading from.
+	bool end;                      ///< Whether the end of the savegame has been read.
+
+	/**
+	 * Initialise this filter.
+	 * @param chain The next filter in this chain.
+	 */
+	LZMABlockLoadFilter(LoadFilter *chain) : LoadFilter(chain), block(0), pos(0), end(false)
+	{
+	}
+
+	/**
+	 * Read exactly the given number of bytes from the chain.
+	 * @param buf  The buffer to read into.
+	 * @param size The number of bytes to read.
+	 * @return False if the end of the file came first.
+	 */
+	bool ReadFully(byte *buf, size_t size)
+	{
+		while (size > 0) {
+			size_t read = this->chain->Read(buf, size);
+			if (read == 0) return false;
+			buf += read;
+			size -= read;
+		}
+		return true;
+	}
+
+	/** Read the next batch of blocks and decompress them. */
+	void ReadBatch()
+	{
+		this->blocks.resize(GetLZMABlockBatchSize());
+		size_t count = 0;
+		while (count < this->blocks.size()) {
+			uint32 hdr[2];
+			if (!this->ReadFully((byte *)hdr, sizeof(hdr))) SlError(STR_GAME_SAVELOAD_ERROR_FILE_NOT_READABLE, "unexpected end of LZMA block data");
+
+			size_t size = TO_BE32(hdr[0]);
+			size_t compressed = TO_BE32(hdr[1]);
+			if (size == 0) {
+				this->end = true;
+				break;
+			}
+			if (size > LZMA_BLOCK_SIZE || compressed > lzma_stream_buffer_bound(LZMA_BLOCK_SIZE)) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_SAVEGAME, "invalid LZMA block size");
+
+			LZMABlock &b = this->blocks[count++];
+			b.data.resize(size);
+			b.compressed.resize(compressed);
+			if (!this->ReadFully(b.compressed.data(), compressed)) SlError(STR_GAME_SAVELOAD_ERROR_FILE_NOT_READABLE, "unexpected end of LZMA block data");
+		}
+		this->blocks.resize(count);
+
+		RunOnWorkerThreads(count, 1, [this](size_t first, size_t last) {
+			for (size_t i = first; i < last; i++) {
+				LZMABlock &b = this->blocks[i];
+				uint64_t memlimit = 1 << 28;
+				size_t in_pos = 0;
+				size_t out_pos = 0;
+				b.ok = lzma_stream_buffer_decode(&memlimit, 0, nullptr, b.compressed.data(), &in_pos, b.compressed.size(), b.data.data(), &out_pos, b.data.size()) == LZMA_OK &&
+						in_pos == b.compressed.size() && out_pos == b.data.size();
+			}
+		});
+
+		for (const LZMABlock &b : this->blocks) {
+			if (!b.ok) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_SAVEGAME, "liblzma returned error code");
+		}
+
+		this->block = 0;
+		this->pos = 0;
+	}
+
+	size_t Read(byte *buf, size_t size) override
+	{
+		size_t read = 0;
+		while (read < size) {
+			if (this->block == this->blocks.size()) {
+				if (this->end) break;
+				this->ReadBatch();
+				continue;
+			}
+
+			const LZMABlock &b = this->blocks[this->block];
+			size_t len = min(size - read, b.data.size() - this->pos);
+			memcpy(buf + read, b.data.data() + this->pos, len);
+			read += len;
+			this->pos += len;
+			if (this->pos == b.data.size()) {
+				this->block++;
+				this->pos = 0;
+			}
+		}
+		return read;
+	}
+
+	void Reset() override
+	{
+		this->blocks.clear();
+		this->block = 0;
+		this->pos = 0;
+		this->end = false;
+		this->chain->Reset();
+	}
+};
+
+/** Filter compressing the LZMA block format on the worker threads. */
+struct LZMABlockSaveFilter : SaveFilter {
+	std::vector<LZMABlock> blocks; ///< The blocks of the current batch.
+	size_t count;                  ///< Number of blocks of the batch that contain data.
+	byte compression_level;        ///< The requested level of compression.
+
+	/**
+	 * Initialise this filter.
+	 * @param chain             The next filter in this chain.
+	 * @param compression_level The requested level of compression.
+	 */
+	LZMABlockSaveFilter(SaveFilter *chain, byte compression_level) : SaveFilter(chain), count(0), compression_level(compression_level)
+	{
+		this->blocks.resize(GetLZMABlockBatchSize());
+	}
+
+	/** Compress the blocks of the current batch and write them, in order. */
+	void WriteBatch()
+	{
+		if (this->count == 0) return;
+
+		RunOnWorkerThreads(this->count, 1, [this](size_t first, size_t last) {
+			for (size_t i = first; i < last; i++) {
+				LZMABlock &b = this->blocks[i];
+				size_t out_pos = 0;
+				b.compressed.resize(lzma_stream_buffer_bound(b.data.size()));
+				b.ok = lzma_easy_buffer_encode(this->compression_level, LZMA_CHECK_CRC32, nullptr, b.data.data(), b.data.size(), b.compressed.data(), &out_pos, b.compressed.size()) == LZMA_OK;
+				b.compressed.resize(out_pos);
+			}
+		});
+
+		for (size_t i = 0; i < this->count; i++) {
+			LZMABlock &b = this->blocks[i];
+			if (!b.ok) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "liblzma returned error code");
+
+			uint32 hdr[2] = { TO_BE32((uint32)b.data.size()), TO_BE32((uint32)b.compressed.size()) };
+			this->chain->Write((byte *)hdr, sizeof(hdr));
+			this->chain->Write(b.compressed.data(), b.compressed.size());
+			b.data.clear();
+		}
+		this->count = 0;
+	}
+
+	void Write(byte *buf, size_t size) override
+	{
+		while (size > 0) {
+			LZMABlock &b = this->blocks[this->count];
+			size_t len = min(size, LZMA_BLOCK_SIZE - b.data.size());
+			b.data.insert(b.data.end(), buf, buf + len);
+			buf += len;
+			size -= len;
+
+			if (b.data.size() == LZMA_BLOCK_SIZE && ++this->count == this->blocks.size()) this->WriteBatch();
+		}
+	}
+
+	void Finish() override
+	{
+		if (this->count < this->blocks.size() && !this->blocks[this->count].data.empty()) this->count++;
+		this->WriteBatch();
+
+		uint32 hdr[2] = { 0, 0 };
+		this->chain->Write((byte *)hdr, sizeof(hdr));
+		this->chain->Finish();
+	}
+};
+
 #endif /* WITH_LIBLZMA */
 
+/********************************************
+ ********** START OF ZSTD CODE **************
+ ********************************************/
+
+#if defined(WITH_ZSTD)
+#include <zstd.h>
+
+/** Filter using Zstandard compression. */
+struct ZSTDLoadFilter : LoadFilter {
+	ZSTD_DStream *zstd;                ///< Stream state that we are reading from.
+	ZSTD_inBuffer in;                  ///< Part of the read buffer that still needs decompressing.
+	byte fread_buf[MEMORY_CHUNK_SIZE]; ///< Buffer for reading from the file.
+
+	/**
+	 * Initialise this filter.
+	 * @param chain The next filter in this chain.
+	 */
+	ZSTDLoadFilter(LoadFilter *chain) : LoadFilter(chain)
+	{
+		this->zstd = ZSTD_createDStream();
+		if (this->zstd == nullptr || ZSTD_isError(ZSTD_initDStream(this->zstd))) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "cannot initialize decompressor");
+		this->in.src = this->fread_buf;
+		this->in.size = 0;
+		this->in.pos = 0;
+	}
+
+	/** Clean everything up. */
+	~ZSTDLoadFilter()
+	{
+		ZSTD_freeDStream(this->zstd);
+	}
+
+	size_t Read(byte *buf, size_t size) override
+	{
+		ZSTD_outBuffer out = { buf, size, 0 };
+
+		do {
+			/* read more bytes from the file? */
+			if (this->in.pos == this->in.size) {
+				this->in.size = this->chain->Read(this->fread_buf, sizeof(this->fread_buf));
+				this->in.pos = 0;
+			}
+
+			/* At the end of the file the decompressor may still hold output
+			 * it could not return yet; keep flushing until it has nothing left. */
+			size_t out_pos = out.pos;
+			size_t r = ZSTD_decompressStream(this->zstd, &out, &this->in);
+			if (ZSTD_isError(r)) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "libzstd returned error code");
+			if (this->in.size == 0 && (r == 0 || out.pos == out_pos)) break;
+		} while (out.pos != out.size);
+
+		return out.pos;
+	}
+};
+
+/** Filter using Zstandard compression. */
+struct ZSTDSaveFilter : SaveFilter {
+	ZSTD_CStream *zstd; ///< Stream state that we are writing to.
+
+	/**
+	 * Initialise this filter.
+	 * @param chain             The next filter in this chain.
+	 * @param compression_level The requested level of compression.
+	 */
+	ZSTDSaveFilter(SaveFilter *chain, byte compression_level) : SaveFilter(chain)
+	{
+		this->zstd = ZSTD_createCStream();
+		if (this->zstd == nullptr || ZSTD_isError(ZSTD_initCStream(this->zstd, compression_level))) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "cannot initialize compressor");
+	}
+
+	/** Clean up what we allocated. */
+	~ZSTDSaveFilter()
+	{
+		ZSTD_freeCStream(this->zstd);
+	}
+
+	void Write(byte *buf, size_t size) override
+	{
+		byte out_buf[MEMORY_CHUNK_SIZE]; // output buffer
+		ZSTD_inBuffer in = { buf, size, 0 };
+
+		while (in.pos != in.size) {
+			ZSTD_outBuffer out = { out_buf, sizeof(out_buf), 0 };
+			size_t r = ZSTD_compressStream(this->zstd, &out, &in);
+			if (ZSTD_isError(r)) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "libzstd returned error code");
+
+			/* bytes were emitted? */
+			if (out.pos != 0) this->chain->Write(out_buf, out.pos);
+		}
+	}
+
+	void Finish() override
+	{
+		byte out_buf[MEMORY_CHUNK_SIZE]; // output buffer
+		size_t remaining;
+
+		do {
+			ZSTD_outBuffer out = { out_buf, sizeof(out_buf), 0 };
+			remaining = ZSTD_endStream(this->zstd, &out);
+			if (ZSTD_isError(remaining)) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "libzstd returned error code");
+
+			/* bytes were emitted? */
+			if (out.pos != 0) this->chain->Write(out_buf, out.pos);
+		} while (remaining != 0);
+
+		this->chain->Finish();
+	}
+};
+
+#endif /* WITH_ZSTD */
+
 /*******************************************
  ************* END OF CODE *****************
  *******************************************/
@@ -2308,7 +2689,17 @@ static const SaveLoadFormat _saveload_formats[] = {
 #else
 	{"zlib",   TO_BE32X('OTTZ'), nullptr,                            nullptr,                            0, 0, 0},
 #endif
+#if defined(WITH_ZSTD)
+	/* Zstandard decompresses a lot faster than lzma and its lower levels also compress faster, at the cost of somewhat bigger
+	 * savegames. Higher levels get close to the size of lzma, but compress slower; levels above 19 need a lot of memory. */
+	{"zstd",   TO_BE32X('OTTS'), CreateLoadFilter<ZSTDLoadFilter>,   CreateSaveFilter<ZSTDSaveFilter>,   1, 9, 19},
+#else
+	{"zstd",   TO_BE32X('OTTS'), nullptr,                            nullptr,                            0, 0, 0},
+#endif
 #if defined(WITH_LIBLZMA)
+	/* The same compression as lzma, but in independent blocks that are compressed and decompressed on all worker threads.
+	 * The blocks make the savegame slightly larger, but saving and loading scale with the number of cores. */
+	{"lzmamt", TO_BE32X('OTTM'), CreateLoadFilter<LZMABlockLoadFilter>, CreateSaveFilter<LZMABlockSaveFilter>, 0, 2, 9},
 	/* Level 2 compression is speed wise as fast as zlib level 6 compression (old default), but results in ~10% smaller saves.
 	 * Higher compression levels are possible, and might improve savegame size by up to 25%, but are also up to 10 times slower.
 	 * The next significant reduction in file size is at level 4, but that is already 4 times slower. Level 3 is primarily 50%
@@ -2316,6 +2707,7 @@ static const SaveLoadFormat _saveload_formats[] = {
 	 * It's OTTX and not e.g. OTTL because liblzma is part of xz-utils and .tar.xz is preferred over .tar.lzma. */
 	{"lzma",   TO_BE32X('OTTX'), CreateLoadFilter<LZMALoadFilter>,   CreateSaveFilter<LZMASaveFilter>,   0, 2, 9},
 #else
+	{"lzmamt", TO_BE32X('OTTM'), nullptr,                            nullptr,                            0, 0, 0},
 	{"lzma",   TO_BE32X('OTTX'), nullptr,                            nullptr,                            0, 0, 0},
 #endif
 };
@@ -2461,8 +2853,10 @@ static SaveOrLoadResult SaveFileToDisk(bool threaded)
 		uint32 hdr[2] = { fmt->tag, TO_BE32(SAVEGAME_VERSION << 16) };
 		_sl.sf->Write((byte*)hdr, sizeof(hdr));
 
+		auto start = std::chrono::steady_clock::now();
 		_sl.sf = fmt->init_write(_sl.sf, compression);
 		_sl.dumper->Flush(_sl.sf);
+		DEBUG(sl, 1, "Compressed and wrote savegame using %s in %i ms", fmt->name, (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
 
 		ClearSaveLoadState();
 
@@ -2491,8 +2885,18 @@ static SaveOrLoadResult SaveFileToDisk(bool threaded)
 	}
 }
 
+/**
+ * Wait until the savegame thread has finished writing.
+ * A forked autosave is not waited for: it is a separate process that does not
+ * touch the game, and finishes on its own even when the game exits. Saving and
+ * loading refuse its file until it is done.
+ */
 void WaitTillSaved()
 {
+#ifdef UNIX
+	PollForkedSave();
+#endif /* UNIX */
+
 	if (!_save_thread.joinable()) return;
 
 	_save_thread.join();
@@ -2535,6 +2939,65 @@ static SaveOrLoadResult DoSave(SaveFilter *writer, bool threaded)
 	return SL_OK;
 }
 
+/**
+ * Write an autosave from a forked copy of the game. The copy shares the memory
+ * of the game copy-on-write, so the game only stalls for the fork itself and
+ * continues running while the copy serialises, compresses and writes the
+ * snapshot. The result is picked up by #ProcessAsyncSaveFinish.
+ *
+ * Only the forking thread survives in the copy, so a lock another thread held
+ * at that moment stays locked there forever. The game is therefore only forked
+ * while the worker pool runs no job and is held, and the copy never uses the pool.
+ * @param fh The file to write the savegame to; closed when the save was started.
+ * @return True when the copy took over the save, false when the game could not be
+ *         forked, or forking is not supported, and the caller must save itself.
+ */
+static bool DoForkedSave(FILE *fh)
+{
+#ifdef UNIX
+	/* Nothing of the game may still be in a stdio buffer, or both copies would write it. */
+	fflush(nullptr);
+
+	if (!TryHoldWorkerThreads()) {
+		DEBUG(sl, 1, "Worker threads are busy, not forking for background autosave...");
+		return false;
+	}
+
+	pid_t pid = fork();
+	if (pid == -1) {
+		ReleaseWorkerThreads();
+		DEBUG(sl, 1, "Cannot fork for background autosave, reverting to normal saving...");
+		return false;
+	}
+
+	if (pid == 0) {
+		/* We're the copy; the other threads did not survive the fork, so keep off the pool. */
+		_worker_threads = 1;
+		SaveOrLoadResult result = SL_ERROR;
+		try {
+			result = DoSave(new FileWriter(fh), false);
+		} catch (...) {
+		}
+		/* Do not run any exit handlers; those belong to the game. */
+		_exit(result == SL_OK ? 0 : 1);
+	}
+
+	ReleaseWorkerThreads();
+
+	struct stat st;
+	if (fstat(fileno(fh), &st) == 0) {
+		_save_child_dev = st.st_dev;
+		_save_child_ino = st.st_ino;
+	}
+	fclose(fh);
+	_save_child = pid;
+	InvalidateWindowData(WC_STATUS_BAR, 0, SBI_SAVELOAD_START);
+	return true;
+#else
+	return false;
+#endif /* UNIX */
+}
+
 /**
  * Save the game using a (writer) filter.
  * @param writer   The filter to write the savegame to.
@@ -2620,6 +3083,7 @@ static SaveOrLoadResult DoLoad(LoadFilter *reader, bool load_check)
 		SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, err_str);
 	}
 
+	auto start = std::chrono::steady_clock::now();
 	_sl.lf = fmt->init_load(_sl.lf);
 	_sl.reader = new ReadBuffer(_sl.lf);
 	_next_offs = 0;
@@ -2666,6 +3130,7 @@ static SaveOrLoadResult DoLoad(LoadFilter *reader, bool load_check)
 		/* Load chunks and resolve references */
 		SlLoadChunks();
 		SlFixPointers();
+		DEBUG(sl, 1, "Read, decompressed and loaded savegame using %s in %i ms", fmt->name, (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
 	}
 
 	ClearSaveLoadState();
@@ -2707,6 +3172,78 @@ SaveOrLoadResult LoadWithFilter(LoadFilter *reader)
 	}
 }
 
+/** Load filter reading from a filter that is owned by someone else. */
+struct BorrowedLoadFilter : LoadFilter {
+	LoadFilter *source; ///< The filter to read from.
+
+	/**
+	 * Initialise this filter.
+	 * @param source The filter to read from.
+	 */
+	BorrowedLoadFilter(LoadFilter *source) : LoadFilter(nullptr), source(source)
+	{
+	}
+
+	size_t Read(byte *buf, size_t size) override
+	{
+		return this->source->Read(buf, size);
+	}
+
+	void Reset() override
+	{
+		this->source->Reset();
+	}
+};
+
+/**
+ * Decompress a savegame, so loading it later on only has to parse it. The
+ * result is written with the header of the uncompressed format. This touches
+ * neither the game state nor the state of the game's save or load, so it may
+ * run on another thread than the game, e.g. while the savegame is still being
+ * received.
+ * @param reader The filter to read the compressed savegame from; it remains owned by the caller.
+ * @param writer The filter to write the decompressed savegame to.
+ * @return Whether the whole savegame could be decompressed.
+ */
+bool DecompressSavegame(LoadFilter *reader, SaveFilter *writer)
+{
+	uint32 hdr[2];
+	if (reader->Read((byte*)hdr, sizeof(hdr)) != sizeof(hdr)) return false;
+
+	const SaveLoadFormat *fmt = _saveload_formats;
+	while (fmt != endof(_saveload_formats) && fmt->tag != hdr[0]) fmt++;
+	if (fmt == endof(_saveload_formats) || fmt->init_load == nullptr) return false;
+
+	/* Keep the version, but there is nothing left to decompress. */
+	hdr[0] = TO_BE32X('OTTN');
+
+	/* Errors must only be recorded, not clean up the game that is running. */
+	DecompressError error;
+	_decompress_error = &error;
+
+	LoadFilter *lf = nullptr;
+	bool success = true;
+	try {
+		writer->Write((byte*)hdr, sizeof(hdr));
+
+		lf = fmt->init_load(new BorrowedLoadFilter(reader));
+		std::vector<byte> buf(MEMORY_CHUNK_SIZE);
+		for (;;) {
+			size_t len = lf->Read(buf.data(), buf.size());
+			if (len == 0) break;
+			writer->Write(buf.data(), len);
+		}
+		writer->Finish();
+	} catch (...) {
+		DEBUG(sl, 0, "Decompressing the savegame failed: %s", error.extra_msg.c_str());
+		success = false;
+	}
+
+	delete lf;
+	_decompress_error = nullptr;
+	return success;
+}
+
 /**
  * Main Save or Load function where the high-level saveload functions are
  * handled. It opens the savegame, selects format and checks versions
@@ -2725,6 +3262,10 @@ SaveOrLoadResult SaveOrLoad(const char *filename, SaveLoadOperation fop, Detaile
 		return SL_OK;
 	}
 	WaitTillSaved();
+#ifdef UNIX
+	/* Do not pile up autosaves while the last one is still being written. */
+	if (PollForkedSave() && fop == SLO_SAVE && _do_autosave) return SL_OK;
+#endif /* UNIX */
 
 	try {
 		/* Load a TTDLX or TTDPatch game */
@@ -2766,6 +3307,18 @@ SaveOrLoadResult SaveOrLoad(const char *filename, SaveLoadOperation fop, Detaile
 			default: NOT_REACHED();
 		}
 
+#ifdef UNIX
+		/* Opening the file for writing would truncate the autosave that is still being written. */
+		if (fop == SLO_SAVE) {
+			FILE *existing = FioFOpenFile(filename, "rb", sb);
+			if (existing != nullptr) {
+				bool busy = IsForkedSaveFile(existing);
+				FioFCloseFile(existing);
+				if (busy) SlError(STR_GAME_SAVELOAD_ERROR_FILE_NOT_WRITEABLE, "The autosave in this file is still being written");
+			}
+		}
+#endif /* UNIX */
+
 		FILE *fh = (fop == SLO_SAVE) ? FioFOpenFile(filename, "wb", sb) : FioFOpenFile(filename, "rb", sb);
 
 		/* Make it a little easier to load savegames from the console */
@@ -2779,6 +3332,7 @@ SaveOrLoadResult SaveOrLoad(const char *filename, SaveLoadOperation fop, Detaile
 
 		if (fop == SLO_SAVE) { // SAVE game
 			DEBUG(desync, 1, "save: %08x; %02x; %s", _date, _date_fract, filename);
+			if (sb == AUTOSAVE_DIR && _settings_client.gui.background_autosaves && DoForkedSave(fh)) return SL_OK;
 			if (_network_server || !_settings_client.gui.threaded_saves) threaded = false;
 
 			return DoSave(new FileWriter(fh), threaded);
@@ -2786,6 +3340,23 @@ SaveOrLoadResult SaveOrLoad(const char *filename, SaveLoadOperation fop, Detaile
 
 		/* LOAD game */
 		assert(fop == SLO_LOAD || fop == SLO_CHECK);
+#ifdef UNIX
+		if (IsForkedSaveFile(fh)) {
+			/* Not through SlError, as that clears the pointers of the game; nothing is loaded yet, so the game just keeps running. */
+			FioFCloseFile(fh);
+			static const char *busy = "The autosave in this file is still being written";
+			if (fop == SLO_CHECK) {
+				_load_check_data.error = STR_GAME_SAVELOAD_ERROR_FILE_NOT_READABLE;
+				free(_load_check_data.error_data);
+				_load_check_data.error_data = stredup(busy);
+			} else {
+				_sl.error_str = STR_GAME_SAVELOAD_ERROR_FILE_NOT_READABLE;
+				free(_sl.extra_msg);
+				_sl.extra_msg = stredup(busy);
+			}
+			return SL_ERROR;
+		}
+#endif /* UNIX */
 		DEBUG(desync, 1, "load: %s", filename);
 		return DoLoad(new FileReader(fh), fop == SLO_CHECK);
 	} catch (...) {
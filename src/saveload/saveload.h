@@ -303,6 +303,8 @@ enum SaveLoadVersion : uint16 {
 	SLV_SCRIPT_MEMLIMIT,                    ///< 215  PR#7516 Limit on AI/GS memory consumption.
 	SLV_MULTITILE_DOCKS,                    ///< 216  PR#7380 Multiple docks per station.
 	SLV_TRADING_AGE,                        ///< 217  PR#7780 Configurable company trading age.
+	SLV_PATH_PREFETCH,                      ///< 218  Searching the paths of road vehicles and ships ahead.
+	SLV_JUNCTION_SEARCH_FACTOR,             ///< 219  Setting for continuing capped rail searches on the junction graph.
 
 	SL_MAX_VERSION,                         ///< Highest possible saveload version
 };
@@ -350,6 +352,7 @@ void DoExitSave();
 
 SaveOrLoadResult SaveWithFilter(struct SaveFilter *writer, bool threaded);
 SaveOrLoadResult LoadWithFilter(struct LoadFilter *reader);
+bool DecompressSavegame(struct LoadFilter *reader, struct SaveFilter *writer);
 
 typedef void ChunkSaveLoadProc();
 typedef void AutolengthProc(void *arg);
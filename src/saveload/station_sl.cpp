@@ -311,18 +311,33 @@ static void SwapPackets(GoodsEntry *ge)
 	StationCargoPacketMap &ge_packets = const_cast<StationCargoPacketMap &>(*ge->cargo.Packets());
 
 	if (_packets.empty()) {
-		std::map<StationID, std::list<CargoPacket *> >::iterator it(ge_packets.find(INVALID_STATION));
+		StationCargoPacketMap::MapIterator it(ge_packets.find(INVALID_STATION));
 		if (it == ge_packets.end()) {
 			return;
 		} else {
-			it->second.swap(_packets);
+			_packets.assign(it->second.begin(), it->second.end());
+			it->second.clear();
 		}
 	} else {
-		assert(ge_packets[INVALID_STATION].empty());
-		ge_packets[INVALID_STATION].swap(_packets);
+		StationCargoPacketMap::List &list = ge_packets[INVALID_STATION];
+		assert(list.empty());
+		for (CargoPacket *cp : _packets) list.push_back(cp);
+		_packets.clear();
 	}
 }
 
+/**
+ * Save the packets of a station for one next hop or fix their pointers. The
+ * packets are saved like a std::list, so they are copied into one and back.
+ * @param packets The next hop and the packets for it.
+ */
+static void SlStationCargoPackets(StationCargoPacketMap::value_type &packets)
+{
+	StationCargoPair pair(packets.first, std::list<CargoPacket *>(packets.second.begin(), packets.second.end()));
+	SlObject(&pair, _cargo_list_desc);
+	std::copy(pair.second.begin(), pair.second.end(), packets.second.begin());
+}
+
 static void Load_STNS()
 {
 	_cargo_source_xy = 0;
@@ -504,7 +519,7 @@ static void RealSave_STNN(BaseStation *bst)
 				}
 			}
 			for (StationCargoPacketMap::ConstMapIterator it(st->goods[i].cargo.Packets()->begin()); it != st->goods[i].cargo.Packets()->end(); ++it) {
-				SlObject(const_cast<StationCargoPacketMap::value_type *>(&(*it)), _cargo_list_desc);
+				SlStationCargoPackets(const_cast<StationCargoPacketMap::value_type &>(*it));
 			}
 		}
 	}
@@ -567,8 +582,9 @@ static void Load_STNN()
 					StationCargoPair pair;
 					for (uint j = 0; j < _num_dests; ++j) {
 						SlObject(&pair, _cargo_list_desc);
-						const_cast<StationCargoPacketMap &>(*(st->goods[i].cargo.Packets()))[pair.first].swap(pair.second);
-						assert(pair.second.empty());
+						StationCargoPacketMap::List &list = const_cast<StationCargoPacketMap &>(*(st->goods[i].cargo.Packets()))[pair.first];
+						for (CargoPacket *cp : pair.second) list.push_back(cp);
+						pair.second.clear();
 					}
 				}
 			}
@@ -601,7 +617,7 @@ static void Ptrs_STNN()
 			} else {
 				SlObject(ge, GetGoodsDesc());
 				for (StationCargoPacketMap::ConstMapIterator it = ge->cargo.Packets()->begin(); it != ge->cargo.Packets()->end(); ++it) {
-					SlObject(const_cast<StationCargoPair *>(&(*it)), _cargo_list_desc);
+					SlStationCargoPackets(const_cast<StationCargoPacketMap::value_type &>(*it));
 				}
 			}
 		}
@@ -32,6 +32,7 @@
 #include "command_func.h"
 #include "console_func.h"
 #include "pathfinder/pathfinder_type.h"
+#include "pathfinder/yapf/yapf_cache.h"
 #include "genworld.h"
 #include "train.h"
 #include "news_func.h"
@@ -67,6 +68,7 @@
 
 #include "void_map.h"
 #include "station_base.h"
+#include "worker_thread.h"
 
 #if defined(WITH_FREETYPE) || defined(_WIN32)
 #define HAS_TRUETYPE_FONT
@@ -1344,6 +1346,19 @@ static bool InvalidateShipPathCache(int32 p1)
 	return true;
 }
 
+/** The cached rail segment costs were calculated with the old penalties. */
+static bool InvalidateYapfCaches(int32 p1)
+{
+	YapfNotifyTrackLayoutChange(INVALID_TILE, INVALID_TRACK);
+	return true;
+}
+
+static bool Forbid90DegChanged(int32 p1)
+{
+	InvalidateYapfCaches(p1);
+	return InvalidateShipPathCache(p1);
+}
+
 static bool UpdateClientName(int32 p1)
 {
 	NetworkUpdateClientName();
@@ -112,6 +112,7 @@ struct GUISettings {
 	bool   disable_unsuitable_building;      ///< disable infrastructure building when no suitable vehicles are available
 	byte   autosave;                         ///< how often should we do autosaves?
 	bool   threaded_saves;                   ///< should we do threaded saves?
+	bool   background_autosaves;             ///< should autosaves be written by a forked copy of the game?
 	bool   keep_all_autosave;                ///< name the autosave in a different way
 	bool   autosave_on_exit;                 ///< save an autosave when you quit the game, but do not ask "Do you really want to quit?"
 	bool   autosave_on_network_disconnect;   ///< save an autosave when you get disconnected from a network game with an error?
@@ -374,6 +375,7 @@ struct NPFSettings {
 struct YAPFSettings {
 	bool   disable_node_optimization;        ///< whether to use exit-dir instead of trackdir in node key
 	uint32 max_search_nodes;                 ///< stop path-finding when this number of nodes visited
+	uint32 rail_junction_search_factor;      ///< how many times max_search_nodes junctions a capped rail search may visit on the junction graph, 0 to not use it
 	uint32 maximum_go_to_depot_penalty;      ///< What is the maximum penalty that may be endured for going to a depot
 	bool   ship_use_yapf;                    ///< use YAPF for ships
 	bool   road_use_yapf;                    ///< use YAPF for road
@@ -417,6 +419,7 @@ struct PathfinderSettings {
 	uint8  pathfinder_for_trains;            ///< the pathfinder to use for trains
 	uint8  pathfinder_for_roadvehs;          ///< the pathfinder to use for roadvehicles
 	uint8  pathfinder_for_ships;             ///< the pathfinder to use for ships
+	bool   path_prefetch;                    ///< search the paths of road vehicles and ships ahead, on the worker threads
 	bool   new_pathfinding_all;              ///< use the newest pathfinding algorithm for all
 
 	bool   roadveh_queue;                    ///< buggy road vehicle queueing
@@ -20,6 +20,7 @@
 #include "station_base.h"
 #include "newgrf_engine.h"
 #include "pathfinder/yapf/yapf.h"
+#include "pathfinder/pf_benchmark.h"
 #include "newgrf_sound.h"
 #include "spritecache.h"
 #include "strings_func.h"
@@ -36,6 +37,7 @@
 #include "framerate_type.h"
 #include "industry.h"
 #include "industry_map.h"
+#include "depot_func.h"
 
 #include "table/strings.h"
 
@@ -145,8 +147,10 @@ void Ship::GetImage(Direction direction, EngineImageType image_type, VehicleSpri
 
 static const Depot *FindClosestShipDepot(const Vehicle *v, uint max_distance)
 {
+	/* No need to look at the depots when none can be close enough. */
+	if (max_distance != 0 && GetDepotDistanceLowerBound(v->tile, v->owner, TRANSPORT_WATER) > max_distance) return nullptr;
+
 	/* Find the closest depot */
-	const Depot *depot;
 	const Depot *best_depot = nullptr;
 	/* If we don't have a maximum distance, i.e. distance = 0,
 	 * we want to find any depot so the best distance of no
@@ -155,14 +159,12 @@ static const Depot *FindClosestShipDepot(const Vehicle *v, uint max_distance)
 	 * further away than max_distance can safely be ignored. */
 	uint best_dist = max_distance == 0 ? UINT_MAX : max_distance + 1;
 
-	FOR_ALL_DEPOTS(depot) {
-		TileIndex tile = depot->xy;
-		if (IsShipDepotTile(tile) && IsTileOwner(tile, v->owner)) {
-			uint dist = DistanceManhattan(tile, v->tile);
-			if (dist < best_dist) {
-				best_dist = dist;
-				best_depot = depot;
-			}
+	for (DepotID index : GetCompanyDepots(v->owner, TRANSPORT_WATER)) {
+		const Depot *depot = Depot::Get(index);
+		uint dist = DistanceManhattan(depot->xy, v->tile);
+		if (dist < best_dist) {
+			best_dist = dist;
+			best_depot = depot;
 		}
 	}
 
@@ -481,6 +483,9 @@ static Track ChooseShipTrack(Ship *v, TileIndex tile, DiagDirection enterdir, Tr
 
 			if (HasBit(tracks, track)) {
 				v->path.pop_front();
+				if (_settings_game.pf.path_prefetch && v->path.size() == YAPF_SHIP_PATH_PREFETCH_LENGTH) {
+					RequestPathPrefetch(v, tile, TrackEnterdirToTrackdir(track, enterdir));
+				}
 				/* HandlePathfindResult() is not called here because this is not a new pathfinder result. */
 				return track;
 			}
@@ -489,6 +494,8 @@ static Track ChooseShipTrack(Ship *v, TileIndex tile, DiagDirection enterdir, Tr
 			v->path.clear();
 		}
 
+		if (_pf_benchmark_active) PfBenchmarkHandleQuery(v, tile, enterdir, tracks);
+
 		switch (_settings_game.pf.pathfinder_for_ships) {
 			case VPF_NPF: track = NPFShipChooseTrack(v, path_found); break;
 			case VPF_YAPF: track = YapfShipChooseTrack(v, tile, enterdir, tracks, path_found, v->path); break;
@@ -17,6 +17,8 @@
 #include "viewport_func.h"
 #include "train.h"
 #include "company_base.h"
+#include <unordered_map>
+#include <vector>
 
 #include "safeguards.h"
 
@@ -166,6 +168,18 @@ public:
 		return true;
 	}
 
+	/**
+	 * Reads the first element that is in the set, without removing it
+	 * @param tile pointer where tile is written to
+	 * @param dir pointer where dir is written to
+	 */
+	void First(TileIndex *tile, Tdir *dir)
+	{
+		assert(this->n != 0);
+		*tile = this->data[0].tile;
+		*dir = this->data[0].dir;
+	}
+
 	/**
 	 * Reads the last added element into the set
 	 * @param tile pointer where tile is written to
@@ -198,6 +212,119 @@ static Vehicle *TrainOnTileEnum(Vehicle *v, void *)
 }
 
 
+/** Current signal block state flags */
+enum SigFlags {
+	SF_NONE   = 0,
+	SF_TRAIN  = 1 << 0, ///< train found in segment
+	SF_EXIT   = 1 << 1, ///< exitsignal found
+	SF_EXIT2  = 1 << 2, ///< two or more exits found
+	SF_GREEN  = 1 << 3, ///< green exitsignal found
+	SF_GREEN2 = 1 << 4, ///< two or more green exits found
+	SF_FULL   = 1 << 5, ///< some of buffers was full, do not continue
+	SF_PBS    = 1 << 6, ///< pbs signal found
+};
+
+DECLARE_ENUM_AS_BIT_SET(SigFlags)
+
+
+/** A check for trains on a tile of a signal segment. */
+struct SignalSegmentProbe {
+	TileIndex tile;   ///< The tile.
+	TrackBits tracks; ///< Tracks to check for trains, or INVALID_TRACK_BIT for any train not in a depot.
+};
+
+/** A tile side or signal of a signal segment. */
+template <typename Tdir>
+struct SignalSegmentItem {
+	TileIndex tile; ///< The tile.
+	Tdir dir;       ///< The side or trackdir.
+};
+
+/**
+ * Exploration of a signal segment from a given start, recorded so the next
+ * update of the segment does not need to explore the tiles again. Everything
+ * the exploration finds depends on the track layout only; the trains and the
+ * states of the pre-signal exits are checked again on every update.
+ */
+struct SignalSegment {
+	SigFlags flags;                                      ///< Flags of the segment that don't depend on trains or signal states.
+	std::vector<SignalSegmentProbe> probes;              ///< Checks for trains, in order of exploration.
+	std::vector<SignalSegmentItem<Trackdir> > exits;     ///< Pre-signal exits leaving the segment.
+	std::vector<SignalSegmentItem<Trackdir> > signals;   ///< Signals to update, in order of exploration.
+	std::vector<SignalSegmentItem<DiagDirection> > sides; ///< Tile sides the exploration passed, in order; they are removed from _globset.
+
+	/** Get the number of items stored for this segment. */
+	size_t Size() const
+	{
+		return this->probes.size() + this->exits.size() + this->signals.size() + this->sides.size();
+	}
+};
+
+/** Compare two probes of signal segments. */
+static inline bool operator ==(const SignalSegmentProbe &a, const SignalSegmentProbe &b)
+{
+	return a.tile == b.tile && a.tracks == b.tracks;
+}
+
+/** Compare two items of signal segments. */
+template <typename Tdir>
+static inline bool operator ==(const SignalSegmentItem<Tdir> &a, const SignalSegmentItem<Tdir> &b)
+{
+	return a.tile == b.tile && a.dir == b.dir;
+}
+
+/** Compare two recorded explorations of signal segments. */
+static bool operator ==(const SignalSegment &a, const SignalSegment &b)
+{
+	return a.flags == b.flags && a.probes == b.probes && a.exits == b.exits && a.signals == b.signals && a.sides == b.sides;
+}
+
+static const size_t SIGNAL_SEGMENT_CACHE_ITEMS = 1 << 20; ///< Maximum number of items stored for all cached signal segments.
+
+static std::unordered_map<uint64, SignalSegment> _signal_segments; ///< Explored signal segments by their start and owner.
+static size_t _signal_segment_items = 0;                            ///< Number of items stored for all cached signal segments.
+
+
+/**
+ * Forget all explored signal segments.
+ * Has to be called whenever tracks, signals or their owners change.
+ */
+void InvalidateSignalSegmentCache()
+{
+	_signal_segments.clear();
+	_signal_segment_items = 0;
+}
+
+
+/**
+ * Check whether there is a train on a tile of a signal segment
+ * @param tile tile to check
+ * @param tracks tracks to check, INVALID_TRACK_BIT for any train not in a depot
+ * @return true iff a train is found
+ */
+static inline bool IsTrainOnTile(TileIndex tile, TrackBits tracks)
+{
+	if (tracks == INVALID_TRACK_BIT) return HasVehicleOnPos(tile, nullptr, &TrainOnTileEnum);
+
+	/* If there is not no train -> there is a train */
+	return EnsureNoTrainOnTrackBits(tile, tracks).Failed();
+}
+
+
+/**
+ * Check for a train on a tile while exploring a signal segment
+ * @param flags flags of the segment, SF_TRAIN is set when a train is found
+ * @param seg exploration being recorded, or nullptr
+ * @param tile tile to check
+ * @param tracks tracks to check, INVALID_TRACK_BIT for any train not in a depot
+ */
+static inline void CheckTrainOnTile(SigFlags &flags, SignalSegment *seg, TileIndex tile, TrackBits tracks = INVALID_TRACK_BIT)
+{
+	if (seg != nullptr) seg->probes.push_back({tile, tracks});
+	if (!(flags & SF_TRAIN) && IsTrainOnTile(tile, tracks)) flags |= SF_TRAIN;
+}
+
+
 /**
  * Perform some operations before adding data into Todo set
  * The new and reverse direction is removed from _globset, because we are sure
@@ -209,10 +336,16 @@ static Vehicle *TrainOnTileEnum(Vehicle *v, void *)
  * @param d1 direction (tile side) we are entering
  * @param t2 tile we are leaving
  * @param d2 direction (tile side) we are leaving
+ * @param seg exploration being recorded, or nullptr
  * @return false iff reverse direction was in Todo set
  */
-static inline bool CheckAddToTodoSet(TileIndex t1, DiagDirection d1, TileIndex t2, DiagDirection d2)
+static inline bool CheckAddToTodoSet(TileIndex t1, DiagDirection d1, TileIndex t2, DiagDirection d2, SignalSegment *seg)
 {
+	if (seg != nullptr) {
+		seg->sides.push_back({t1, d1});
+		seg->sides.push_back({t2, d2});
+	}
+
 	_globset.Remove(t1, d1); // it can be in Global but not in Todo
 	_globset.Remove(t2, d2); // remove in all cases
 
@@ -235,38 +368,25 @@ static inline bool CheckAddToTodoSet(TileIndex t1, DiagDirection d1, TileIndex t
  * @param d1 direction (tile side) we are entering
  * @param t2 tile we are leaving
  * @param d2 direction (tile side) we are leaving
+ * @param seg exploration being recorded, or nullptr
  * @return false iff the Todo buffer would be overrun
  */
-static inline bool MaybeAddToTodoSet(TileIndex t1, DiagDirection d1, TileIndex t2, DiagDirection d2)
+static inline bool MaybeAddToTodoSet(TileIndex t1, DiagDirection d1, TileIndex t2, DiagDirection d2, SignalSegment *seg)
 {
-	if (!CheckAddToTodoSet(t1, d1, t2, d2)) return true;
+	if (!CheckAddToTodoSet(t1, d1, t2, d2, seg)) return true;
 
 	return _tbdset.Add(t1, d1);
 }
 
 
-/** Current signal block state flags */
-enum SigFlags {
-	SF_NONE   = 0,
-	SF_TRAIN  = 1 << 0, ///< train found in segment
-	SF_EXIT   = 1 << 1, ///< exitsignal found
-	SF_EXIT2  = 1 << 2, ///< two or more exits found
-	SF_GREEN  = 1 << 3, ///< green exitsignal found
-	SF_GREEN2 = 1 << 4, ///< two or more green exits found
-	SF_FULL   = 1 << 5, ///< some of buffers was full, do not continue
-	SF_PBS    = 1 << 6, ///< pbs signal found
-};
-
-DECLARE_ENUM_AS_BIT_SET(SigFlags)
-
-
 /**
  * Search signal block
  *
  * @param owner owner whose signals we are updating
+ * @param seg exploration to record, or nullptr
  * @return SigFlags
  */
-static SigFlags ExploreSegment(Owner owner)
+static SigFlags ExploreSegment(Owner owner, SignalSegment *seg)
 {
 	SigFlags flags = SF_NONE;
 
@@ -283,13 +403,13 @@ static SigFlags ExploreSegment(Owner owner)
 
 				if (IsRailDepot(tile)) {
 					if (enterdir == INVALID_DIAGDIR) { // from 'inside' - train just entered or left the depot
-						if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, nullptr, &TrainOnTileEnum)) flags |= SF_TRAIN;
+						CheckTrainOnTile(flags, seg, tile);
 						exitdir = GetRailDepotDirection(tile);
 						tile += TileOffsByDiagDir(exitdir);
 						enterdir = ReverseDiagDir(exitdir);
 						break;
 					} else if (enterdir == GetRailDepotDirection(tile)) { // entered a depot
-						if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, nullptr, &TrainOnTileEnum)) flags |= SF_TRAIN;
+						CheckTrainOnTile(flags, seg, tile);
 						continue;
 					} else {
 						continue;
@@ -302,11 +422,10 @@ static SigFlags ExploreSegment(Owner owner)
 
 				if (tracks == TRACK_BIT_HORZ || tracks == TRACK_BIT_VERT) { // there is exactly one incidating track, no need to check
 					tracks = tracks_masked;
-					/* If no train detected yet, and there is not no train -> there is a train -> set the flag */
-					if (!(flags & SF_TRAIN) && EnsureNoTrainOnTrackBits(tile, tracks).Failed()) flags |= SF_TRAIN;
+					CheckTrainOnTile(flags, seg, tile, tracks);
 				} else {
 					if (tracks_masked == TRACK_BIT_NONE) continue; // no incidating track
-					if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, nullptr, &TrainOnTileEnum)) flags |= SF_TRAIN;
+					CheckTrainOnTile(flags, seg, tile);
 				}
 
 				if (HasSignals(tile)) { // there is exactly one track - not zero, because there is exit from this tile
@@ -321,12 +440,16 @@ static SigFlags ExploreSegment(Owner owner)
 						if (HasSignalOnTrackdir(tile, reversedir)) {
 							if (IsPbsSignal(sig)) {
 								flags |= SF_PBS;
-							} else if (!_tbuset.Add(tile, reversedir)) {
-								return flags | SF_FULL;
+							} else {
+								if (seg != nullptr) seg->signals.push_back({tile, reversedir});
+								if (!_tbuset.Add(tile, reversedir)) return flags | SF_FULL;
 							}
 						}
 						if (HasSignalOnTrackdir(tile, trackdir) && !IsOnewaySignal(tile, track)) flags |= SF_PBS;
 
+						/* record every presignal exit, the green ones are counted when the segment is replayed */
+						if (seg != nullptr && IsPresignalExit(tile, track) && HasSignalOnTrackdir(tile, trackdir)) seg->exits.push_back({tile, trackdir});
+
 						/* if it is a presignal EXIT in OUR direction and we haven't found 2 green exits yes, do special check */
 						if (!(flags & SF_GREEN2) && IsPresignalExit(tile, track) && HasSignalOnTrackdir(tile, trackdir)) { // found presignal exit
 							if (flags & SF_EXIT) flags |= SF_EXIT2; // found two (or more) exits
@@ -345,7 +468,7 @@ static SigFlags ExploreSegment(Owner owner)
 					if (dir != enterdir && (tracks & _enterdir_to_trackbits[dir])) { // any track incidating?
 						TileIndex newtile = tile + TileOffsByDiagDir(dir);  // new tile to check
 						DiagDirection newdir = ReverseDiagDir(dir); // direction we are entering from
-						if (!MaybeAddToTodoSet(newtile, newdir, tile, dir)) return flags | SF_FULL;
+						if (!MaybeAddToTodoSet(newtile, newdir, tile, dir, seg)) return flags | SF_FULL;
 					}
 				}
 
@@ -358,7 +481,7 @@ static SigFlags ExploreSegment(Owner owner)
 				if (DiagDirToAxis(enterdir) != GetRailStationAxis(tile)) continue; // different axis
 				if (IsStationTileBlocked(tile)) continue; // 'eye-candy' station tile
 
-				if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, nullptr, &TrainOnTileEnum)) flags |= SF_TRAIN;
+				CheckTrainOnTile(flags, seg, tile);
 				tile += TileOffsByDiagDir(exitdir);
 				break;
 
@@ -367,7 +490,7 @@ static SigFlags ExploreSegment(Owner owner)
 				if (GetTileOwner(tile) != owner) continue;
 				if (DiagDirToAxis(enterdir) == GetCrossingRoadAxis(tile)) continue; // different axis
 
-				if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, nullptr, &TrainOnTileEnum)) flags |= SF_TRAIN;
+				CheckTrainOnTile(flags, seg, tile);
 				tile += TileOffsByDiagDir(exitdir);
 				break;
 
@@ -377,13 +500,13 @@ static SigFlags ExploreSegment(Owner owner)
 				DiagDirection dir = GetTunnelBridgeDirection(tile);
 
 				if (enterdir == INVALID_DIAGDIR) { // incoming from the wormhole
-					if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, nullptr, &TrainOnTileEnum)) flags |= SF_TRAIN;
+					CheckTrainOnTile(flags, seg, tile);
 					enterdir = dir;
 					exitdir = ReverseDiagDir(dir);
 					tile += TileOffsByDiagDir(exitdir); // just skip to next tile
 				} else { // NOT incoming from the wormhole!
 					if (ReverseDiagDir(enterdir) != dir) continue;
-					if (!(flags & SF_TRAIN) && HasVehicleOnPos(tile, nullptr, &TrainOnTileEnum)) flags |= SF_TRAIN;
+					CheckTrainOnTile(flags, seg, tile);
 					tile = GetOtherTunnelBridgeEnd(tile); // just skip to exit tile
 					enterdir = INVALID_DIAGDIR;
 					exitdir = INVALID_DIAGDIR;
@@ -395,13 +518,95 @@ static SigFlags ExploreSegment(Owner owner)
 				continue; // continue the while() loop
 		}
 
-		if (!MaybeAddToTodoSet(tile, enterdir, oldtile, exitdir)) return flags | SF_FULL;
+		if (!MaybeAddToTodoSet(tile, enterdir, oldtile, exitdir, seg)) return flags | SF_FULL;
 	}
 
 	return flags;
 }
 
 
+/**
+ * Update the flags of a signal segment and the sets like ExploreSegment()
+ * would, from a recorded exploration of the segment.
+ *
+ * @param seg recorded exploration of the segment
+ * @return SigFlags
+ */
+static SigFlags ReplaySegment(const SignalSegment &seg)
+{
+	SigFlags flags = seg.flags;
+
+	_tbdset.Reset();
+	/* the caller resets all sets when some buffer was full */
+	if (flags & SF_FULL) return flags;
+
+	if (!_globset.IsEmpty()) {
+		for (const SignalSegmentItem<DiagDirection> &side : seg.sides) _globset.Remove(side.tile, side.dir);
+	}
+
+	for (const SignalSegmentProbe &probe : seg.probes) {
+		if (IsTrainOnTile(probe.tile, probe.tracks)) {
+			flags |= SF_TRAIN;
+			break;
+		}
+	}
+
+	for (const SignalSegmentItem<Trackdir> &exit : seg.exits) {
+		if (GetSignalStateByTrackdir(exit.tile, exit.dir) != SIGNAL_STATE_GREEN) continue;
+		if (flags & SF_GREEN) {
+			flags |= SF_GREEN2;
+			break;
+		}
+		flags |= SF_GREEN;
+	}
+
+	for (const SignalSegmentItem<Trackdir> &signal : seg.signals) _tbuset.Add(signal.tile, signal.dir);
+
+	return flags;
+}
+
+
+/**
+ * Search signal block, or replay its recorded exploration when the block
+ * was explored from the same start before. Only the trains and the states
+ * of the pre-signal exits are checked for a recorded block.
+ *
+ * @param owner owner whose signals we are updating
+ * @return SigFlags
+ */
+static SigFlags ExploreSegmentCached(Owner owner)
+{
+	/* the first one or two items in _tbdset are determined by the first one */
+	TileIndex tile;
+	DiagDirection dir;
+	_tbdset.First(&tile, &dir);
+	uint64 key = (uint64)tile << 16 | (uint64)(byte)dir << 8 | (uint64)(_tbdset.Items() > 1) << 7 | owner;
+
+	auto it = _signal_segments.find(key);
+	if (it != _signal_segments.end() && _debug_desync_level < 2) return ReplaySegment(it->second);
+
+	SignalSegment seg;
+	SigFlags flags = ExploreSegment(owner, &seg);
+	seg.flags = flags & (SF_EXIT | SF_EXIT2 | SF_PBS | SF_FULL);
+
+	if (it != _signal_segments.end()) {
+		/* desync debugging: check that the recorded exploration is still valid */
+		if (!(it->second == seg)) {
+			DEBUG(desync, 2, "signal segment cache mismatch: tile 0x%x, dir %d, owner %d", tile, dir, owner);
+			_signal_segment_items += seg.Size() - it->second.Size();
+			it->second = std::move(seg);
+		}
+		return flags;
+	}
+
+	if (_signal_segment_items + seg.Size() > SIGNAL_SEGMENT_CACHE_ITEMS) InvalidateSignalSegmentCache();
+	_signal_segment_items += seg.Size();
+	_signal_segments.emplace(key, std::move(seg));
+
+	return flags;
+}
+
+
 /**
  * Update signals around segment in _tbuset
  *
@@ -531,7 +736,7 @@ static SigSegState UpdateSignalsInBuffer(Owner owner)
 		assert(!_tbdset.Overflowed()); // it really shouldn't overflow by these one or two items
 		assert(!_tbdset.IsEmpty()); // it wouldn't hurt anyone, but shouldn't happen too
 
-		SigFlags flags = ExploreSegment(owner);
+		SigFlags flags = ExploreSegmentCached(owner);
 
 		if (first) {
 			first = false;
@@ -593,6 +798,9 @@ void AddTrackToSignalBuffer(TileIndex tile, Track track, Owner owner)
 
 	_last_owner = owner;
 
+	/* the track layout changed, so the explored segments may have changed too */
+	InvalidateSignalSegmentCache();
+
 	_globset.Add(tile, _search_dir_1[track]);
 	_globset.Add(tile, _search_dir_2[track]);
 
@@ -618,6 +826,9 @@ void AddSideToSignalBuffer(TileIndex tile, DiagDirection side, Owner owner)
 
 	_last_owner = owner;
 
+	/* the track layout changed, so the explored segments may have changed too */
+	InvalidateSignalSegmentCache();
+
 	_globset.Add(tile, side);
 
 	if (_globset.Items() >= SIG_GLOB_UPDATE) {
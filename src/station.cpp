@@ -29,6 +29,8 @@
 #include "core/random_func.hpp"
 #include "linkgraph/linkgraph.h"
 #include "linkgraph/linkgraphschedule.h"
+#include "station_func.h"
+#include <algorithm>
 
 #include "table/strings.h"
 
@@ -138,6 +140,7 @@ Station::~Station()
 
 	/* Remove station from industries and towns that reference it. */
 	this->RemoveFromAllNearbyLists();
+	this->RemoveFromCatchmentIndex();
 
 	/* Clear the persistent storage. */
 	delete this->airport.psa;
@@ -408,6 +411,84 @@ bool Station::CatchmentCoversTown(TownID t) const
 	return false;
 }
 
+static const uint CATCHMENT_INDEX_CELL_BITS = 4; ///< Log2 of the size of the cells of the catchment index, in tiles.
+
+/**
+ * Index of the catchment areas of all stations. The map is divided into cells
+ * of 1 << #CATCHMENT_INDEX_CELL_BITS by 1 << #CATCHMENT_INDEX_CELL_BITS tiles;
+ * every cell lists the stations, sorted by index, whose catchment area overlaps
+ * the cell. So the stations that may cover a tile are found without scanning
+ * the surroundings of the tile for station tiles.
+ */
+static std::vector<std::vector<StationID> > _catchment_index;
+
+/** Remove all stations from the catchment index, e.g. when all stations are removed at once. */
+void ResetCatchmentIndex()
+{
+	_catchment_index.clear();
+}
+
+/**
+ * Call a function for all cells of the catchment index that overlap an area.
+ * @param area The area.
+ * @param proc Function to call with the list of stations of every cell.
+ */
+template <typename Tproc>
+static void ForAllCatchmentIndexCells(const TileArea &area, Tproc proc)
+{
+	if (area.tile == INVALID_TILE || area.w == 0 || area.h == 0) return;
+
+	uint cells_x = MapSizeX() >> CATCHMENT_INDEX_CELL_BITS;
+	uint cells = cells_x * (MapSizeY() >> CATCHMENT_INDEX_CELL_BITS);
+	if (_catchment_index.size() != cells) {
+		_catchment_index.clear();
+		_catchment_index.resize(cells);
+	}
+
+	uint left = TileX(area.tile) >> CATCHMENT_INDEX_CELL_BITS;
+	uint right = (TileX(area.tile) + area.w - 1) >> CATCHMENT_INDEX_CELL_BITS;
+	uint top = TileY(area.tile) >> CATCHMENT_INDEX_CELL_BITS;
+	uint bottom = (TileY(area.tile) + area.h - 1) >> CATCHMENT_INDEX_CELL_BITS;
+	for (uint y = top; y <= bottom; y++) {
+		for (uint x = left; x <= right; x++) {
+			proc(_catchment_index[y * cells_x + x]);
+		}
+	}
+}
+
+/**
+ * Find the stations whose catchment area overlaps an area. Whether they
+ * actually cover any tile of the area still has to be tested.
+ * @param area The area.
+ * @param[out] stations The set to add the stations to.
+ */
+void FindCatchmentIndexStations(const TileArea &area, std::set<StationID> *stations)
+{
+	ForAllCatchmentIndexCells(area, [stations](const std::vector<StationID> &cell) {
+		stations->insert(cell.begin(), cell.end());
+	});
+}
+
+/** Add this station to the catchment index, for its current catchment area. */
+void Station::AddToCatchmentIndex()
+{
+	StationID index = this->index;
+	ForAllCatchmentIndexCells(this->catchment_tiles, [index](std::vector<StationID> &cell) {
+		std::vector<StationID>::iterator it = std::lower_bound(cell.begin(), cell.end(), index);
+		if (it == cell.end() || *it != index) cell.insert(it, index);
+	});
+}
+
+/** Remove this station from the catchment index, for its current catchment area. */
+void Station::RemoveFromCatchmentIndex()
+{
+	StationID index = this->index;
+	ForAllCatchmentIndexCells(this->catchment_tiles, [index](std::vector<StationID> &cell) {
+		std::vector<StationID>::iterator it = std::lower_bound(cell.begin(), cell.end(), index);
+		if (it != cell.end() && *it == index) cell.erase(it);
+	});
+}
+
 /**
  * Recompute tiles covered in our catchment area.
  * This will additionally recompute nearby towns and industries.
@@ -416,6 +497,7 @@ void Station::RecomputeCatchment()
 {
 	this->industries_near.clear();
 	this->RemoveFromAllNearbyLists();
+	this->RemoveFromCatchmentIndex();
 
 	if (this->rect.IsEmpty()) {
 		this->catchment_tiles.Reset();
@@ -437,6 +519,7 @@ void Station::RecomputeCatchment()
 		this->industry->stations_near.clear();
 		this->industry->stations_near.insert(this);
 		this->industries_near.insert(this->industry);
+		this->AddToCatchmentIndex();
 		return;
 	}
 
@@ -454,6 +537,7 @@ void Station::RecomputeCatchment()
 		TileArea ta2 = TileArea(tile, 1, 1).Expand(r);
 		TILE_AREA_LOOP(tile2, ta2) this->catchment_tiles.SetTile(tile2);
 	}
+	this->AddToCatchmentIndex();
 
 	/* Search catchment tiles for towns and industries */
 	BitmapTileIterator it(this->catchment_tiles);
@@ -57,6 +57,8 @@
 #include "linkgraph/refresh.h"
 #include "widgets/station_widget.h"
 #include "tunnelbridge_map.h"
+#include "console_func.h"
+#include <chrono>
 
 #include "table/strings.h"
 
@@ -3468,7 +3470,19 @@ static void UpdateStationRating(Station *st)
 	byte_inc_sat(&st->time_since_load);
 	byte_inc_sat(&st->time_since_unload);
 
+	/* Stations without rated cargo and without ratings to recover, e.g.
+	 * stations that are not serviced anymore, don't change at all. */
+	bool rated = false;
 	const CargoSpec *cs;
+	FOR_ALL_CARGOSPECS(cs) {
+		const GoodsEntry *ge = &st->goods[cs->Index()];
+		if (ge->HasRating() || ge->rating < INITIAL_STATION_RATING) {
+			rated = true;
+			break;
+		}
+	}
+	if (!rated) return;
+
 	FOR_ALL_CARGOSPECS(cs) {
 		GoodsEntry *ge = &st->goods[cs->Index()];
 		/* Slowly increase the rating back to his original level in the case we
@@ -3655,12 +3669,17 @@ void DeleteStaleLinks(Station *from)
 		GoodsEntry &ge = from->goods[c];
 		LinkGraph *lg = LinkGraph::GetIfValid(ge.link_graph);
 		if (lg == nullptr) continue;
+		/* Refreshing links below may add nodes and edges, which moves them
+		 * around in memory. So remember the destinations and look up the edges
+		 * again whenever needed. */
+		std::vector<NodeID> dests;
 		Node node = (*lg)[ge.node];
-		for (EdgeIterator it(node.Begin()); it != node.End();) {
-			Edge edge = it->second;
-			Station *to = Station::Get((*lg)[it->first].Station());
-			assert(to->goods[c].node == it->first);
-			++it; // Do that before removing the edge. Anything else may crash.
+		for (EdgeIterator it(node.Begin()); it != node.End(); ++it) dests.push_back(it->first);
+
+		for (NodeID dest : dests) {
+			Edge edge = (*lg)[ge.node][dest];
+			Station *to = Station::Get((*lg)[dest].Station());
+			assert(to->goods[c].node == dest);
 			assert(_date >= edge.LastUpdate());
 			uint timeout = LinkGraph::MIN_TIMEOUT_DISTANCE + (DistanceManhattan(from->xy, to->xy) >> 3);
 			if ((uint)(_date - edge.LastUpdate()) > timeout) {
@@ -3693,7 +3712,7 @@ void DeleteStaleLinks(Station *from)
 						Vehicle *v = *iter;
 
 						LinkRefresher::Run(v, false); // Don't allow merging. Otherwise lg might get deleted.
-						if (edge.LastUpdate() == _date) {
+						if ((*lg)[ge.node][dest].LastUpdate() == _date) {
 							updated = true;
 							break;
 						}
@@ -3712,7 +3731,7 @@ void DeleteStaleLinks(Station *from)
 
 				if (!updated) {
 					/* If it's still considered dead remove it. */
-					node.RemoveEdge(to->goods[c].node);
+					(*lg)[ge.node].RemoveEdge(dest);
 					ge.flows.DeleteFlows(to->index);
 					RerouteCargo(from, c, to->index, from->index);
 				}
@@ -3966,10 +3985,39 @@ CommandCost CmdRenameStation(TileIndex tile, DoCommandFlag flags, uint32 p1, uin
 	return CommandCost();
 }
 
-static void AddNearbyStationsByCatchment(TileIndex tile, StationList *stations, StationList &nearby)
+/**
+ * Find all stations around a rectangular producer by scanning the area around
+ * it for station tiles. This is what #FindStationsAroundTiles used to do before
+ * the catchment index; it is kept to verify and benchmark the index.
+ * @param location The location/area of the producer
+ * @param[out] stations The list to store the stations in
+ */
+static void ScanStationsAroundTiles(const TileArea &location, StationList * const stations)
 {
-	for (Station *st : nearby) {
-		if (st->TileIsInCatchment(tile)) stations->insert(st);
+	std::set<StationID> seen_stations;
+
+	/* Scan an area around the building covering the maximum possible station
+	 * to find the possible nearby stations. */
+	uint max_c = _settings_game.station.modified_catchment ? MAX_CATCHMENT : CA_UNMODIFIED;
+	TileArea ta = TileArea(location).Expand(max_c);
+	TILE_AREA_LOOP(tile, ta) {
+		if (IsTileType(tile, MP_STATION)) seen_stations.insert(GetStationIndex(tile));
+	}
+
+	for (StationID stationid : seen_stations) {
+		Station *st = Station::GetIfValid(stationid);
+		if (st == nullptr) continue; /* Waypoint */
+
+		/* Check if station is attached to an industry */
+		if (!_settings_game.station.serve_neutral_industries && st->industry != nullptr) continue;
+
+		/* Test if the tile is within the station's catchment */
+		TILE_AREA_LOOP(tile, location) {
+			if (st->TileIsInCatchment(tile)) {
+				stations->insert(st);
+				break;
+			}
+		}
 	}
 }
 
@@ -3982,34 +4030,31 @@ static void AddNearbyStationsByCatchment(TileIndex tile, StationList *stations,
  */
 void FindStationsAroundTiles(const TileArea &location, StationList * const stations, bool use_nearby)
 {
-	if (use_nearby) {
-		/* Industries and towns maintain a list of nearby stations */
-		if (IsTileType(location.tile, MP_INDUSTRY)) {
-			/* Industry nearby stations are already filtered by catchment. */
-			*stations = Industry::GetByTile(location.tile)->stations_near;
-			return;
-		} else if (IsTileType(location.tile, MP_HOUSE)) {
-			/* Town nearby stations need to be filtered per tile. */
-			assert(location.w == 1 && location.h == 1);
-			AddNearbyStationsByCatchment(location.tile, stations, Town::GetByTile(location.tile)->stations_near);
-			return;
-		}
+	if (use_nearby && IsTileType(location.tile, MP_INDUSTRY)) {
+		/* Industry nearby stations are already filtered by catchment. */
+		*stations = Industry::GetByTile(location.tile)->stations_near;
+		return;
 	}
 
-	/* Not using, or don't have a nearby stations list, so we need to scan. */
-	std::set<StationID> seen_stations;
+	/* The catchment index gives the few stations whose catchment area is
+	 * near; whether they cover the location still has to be tested. */
+	std::set<StationID> near_stations;
+	FindCatchmentIndexStations(location, &near_stations);
 
-	/* Scan an area around the building covering the maximum possible station
-	 * to find the possible nearby stations. */
-	uint max_c = _settings_game.station.modified_catchment ? MAX_CATCHMENT : CA_UNMODIFIED;
-	TileArea ta = TileArea(location).Expand(max_c);
-	TILE_AREA_LOOP(tile, ta) {
-		if (IsTileType(tile, MP_STATION)) seen_stations.insert(GetStationIndex(tile));
+	if (use_nearby && IsTileType(location.tile, MP_HOUSE)) {
+		/* Town nearby stations need to be filtered per tile. */
+		assert(location.w == 1 && location.h == 1);
+		const StationList &town_stations = Town::GetByTile(location.tile)->stations_near;
+		for (StationID stationid : near_stations) {
+			Station *st = Station::GetIfValid(stationid);
+			if (st != nullptr && st->TileIsInCatchment(location.tile) && town_stations.count(st) != 0) stations->insert(st);
+		}
+		return;
 	}
 
-	for (StationID stationid : seen_stations) {
+	for (StationID stationid : near_stations) {
 		Station *st = Station::GetIfValid(stationid);
-		if (st == nullptr) continue; /* Waypoint */
+		if (st == nullptr) continue;
 
 		/* Check if station is attached to an industry */
 		if (!_settings_game.station.serve_neutral_industries && st->industry != nullptr) continue;
@@ -4024,6 +4069,42 @@ void FindStationsAroundTiles(const TileArea &location, StationList * const stati
 	}
 }
 
+/**
+ * Compare finding the stations around all houses and industries with the
+ * catchment index against scanning the area around them, and print how long
+ * both took and whether they found the same stations.
+ */
+void BenchmarkCatchmentIndex()
+{
+	std::vector<TileArea> locations;
+	for (TileIndex tile = 0; tile < MapSize(); tile++) {
+		if (IsTileType(tile, MP_HOUSE)) locations.emplace_back(tile, 1, 1);
+	}
+	const Industry *ind;
+	FOR_ALL_INDUSTRIES(ind) locations.push_back(ind->location);
+
+	std::vector<StationList> indexed(locations.size());
+	std::vector<StationList> scanned(locations.size());
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < locations.size(); i++) FindStationsAroundTiles(locations[i], &indexed[i], false);
+	auto middle = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < locations.size(); i++) ScanStationsAroundTiles(locations[i], &scanned[i]);
+	auto end = std::chrono::high_resolution_clock::now();
+
+	uint found = 0;
+	uint mismatches = 0;
+	for (size_t i = 0; i < locations.size(); i++) {
+		found += (uint)indexed[i].size();
+		if (indexed[i] != scanned[i]) mismatches++;
+	}
+
+	double index_us = std::chrono::duration_cast<std::chrono::nanoseconds>(middle - start).count() / 1000.0;
+	double scan_us = std::chrono::duration_cast<std::chrono::nanoseconds>(end - middle).count() / 1000.0;
+	IConsolePrintF(CC_DEFAULT, "Found %u stations around %u producers, %u mismatches", found, (uint)locations.size(), mismatches);
+	IConsolePrintF(CC_DEFAULT, "Catchment index: %.0f us, area scan: %.0f us", index_us, scan_us);
+}
+
 /**
  * Run a tile loop to find stations around a tile, on demand. Cache the result for further requests
  * @return pointer to a StationList containing all stations found
@@ -4446,6 +4527,7 @@ void FlowStat::Invalidate()
 {
 	assert(!this->shares.empty());
 	SharesMap new_shares;
+	new_shares.reserve(this->shares.size());
 	uint i = 0;
 	for (SharesMap::iterator it(this->shares.begin()); it != this->shares.end(); ++it) {
 		new_shares[++i] = it->second;
@@ -4467,10 +4549,31 @@ void FlowStat::ChangeShare(StationID st, int flow)
 	 * be empty. In that case the whole flow stat must be deleted then. */
 	assert(!this->shares.empty());
 
+	if (flow > 0) {
+		/* Adding flow doesn't remove any shares, so the cumulative shares can
+		 * be updated in place. */
+		SharesMap::iterator it(this->shares.begin());
+		while (it != this->shares.end() && it->second != st) ++it;
+		if (it != this->shares.end()) {
+			if (it->first <= this->unrestricted) this->unrestricted += flow;
+			for (; it != this->shares.end(); ++it) it->first += flow;
+		} else {
+			uint last_share = this->shares.back().first;
+			if (this->unrestricted < last_share) {
+				this->ReleaseShare(st);
+			} else {
+				this->unrestricted += flow;
+			}
+			this->shares[last_share + (uint)flow] = st;
+		}
+		return;
+	}
+
 	uint removed_shares = 0;
 	uint added_shares = 0;
 	uint last_share = 0;
 	SharesMap new_shares;
+	new_shares.reserve(this->shares.size());
 	for (SharesMap::iterator it(this->shares.begin()); it != this->shares.end(); ++it) {
 		if (it->second == st) {
 			if (flow < 0) {
@@ -4562,6 +4665,7 @@ void FlowStat::ReleaseShare(StationID st)
 	}
 	if (flow == 0) return;
 	SharesMap new_shares;
+	new_shares.reserve(this->shares.size());
 	new_shares[flow] = st;
 	for (SharesMap::iterator it(this->shares.begin()); it != this->shares.end(); ++it) {
 		if (it->second != st) {
@@ -4583,6 +4687,7 @@ void FlowStat::ScaleToMonthly(uint runtime)
 {
 	assert(runtime > 0);
 	SharesMap new_shares;
+	new_shares.reserve(this->shares.size());
 	uint share = 0;
 	for (SharesMap::iterator i = this->shares.begin(); i != this->shares.end(); ++i) {
 		share = max(share + 1, i->first * 30 / runtime);
@@ -25,6 +25,8 @@
 void ModifyStationRatingAround(TileIndex tile, Owner owner, int amount, uint radius);
 
 void FindStationsAroundTiles(const TileArea &location, StationList *stations, bool use_nearby = true);
+void FindCatchmentIndexStations(const TileArea &area, std::set<StationID> *stations);
+void ResetCatchmentIndex();
 
 void ShowStationViewWindow(StationID station);
 void UpdateAllStationVirtCoords();
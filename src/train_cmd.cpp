@@ -15,6 +15,7 @@
 #include "command_func.h"
 #include "pathfinder/npf/npf_func.h"
 #include "pathfinder/yapf/yapf.hpp"
+#include "pathfinder/pf_benchmark.h"
 #include "news_func.h"
 #include "company_func.h"
 #include "newgrf_sound.h"
@@ -2311,6 +2312,8 @@ static const byte _initial_tile_subcoord[6][4][3] = {
  */
 static Track DoTrainPathfind(const Train *v, TileIndex tile, DiagDirection enterdir, TrackBits tracks, bool &path_found, bool do_track_reservation, PBSTileInfo *dest)
 {
+	if (_pf_benchmark_active) PfBenchmarkHandleQuery(v, tile, enterdir, tracks);
+
 	switch (_settings_game.pf.pathfinder_for_trains) {
 		case VPF_NPF: return NPFTrainChooseTrack(v, path_found, do_track_reservation, dest);
 		case VPF_YAPF: return YapfTrainChooseTrack(v, tile, enterdir, tracks, path_found, do_track_reservation, dest);
@@ -53,6 +53,10 @@
 #include "linkgraph/linkgraph.h"
 #include "linkgraph/refresh.h"
 #include "framerate_type.h"
+#include "worker_thread.h"
+#include "pathfinder/yapf/yapf.h"
+#include <algorithm>
+#include <vector>
 
 #include "table/strings.h"
 
@@ -377,8 +381,15 @@ const int TOTAL_HASH_MASK = TOTAL_HASH_SIZE - 1;
  * Profiling results show that 0 is fastest. */
 const int HASH_RES = 0;
 
+/* Distance from a location in which vehicles are searched by VehicleFromPosXY. */
+const int COLL_DIST = 6;
+
 static Vehicle *_vehicle_tile_hash[TOTAL_HASH_SIZE];
 
+/* The road vehicles of every bucket of _vehicle_tile_hash, stored contiguously
+ * so the blocking checks of road vehicles only need to walk an array. */
+static std::vector<Vehicle *> _road_vehicle_tile_hash[TOTAL_HASH_SIZE];
+
 static Vehicle *VehicleFromTileHash(int xl, int yl, int xu, int yu, void *data, VehicleFromPosProc *proc, bool find_first)
 {
 	for (int y = yl; ; y = (y + (1 << HASH_BITS)) & (HASH_MASK << HASH_BITS)) {
@@ -410,8 +421,6 @@ static Vehicle *VehicleFromTileHash(int xl, int yl, int xu, int yu, void *data,
  */
 static Vehicle *VehicleFromPosXY(int x, int y, void *data, VehicleFromPosProc *proc, bool find_first)
 {
-	const int COLL_DIST = 6;
-
 	/* Hash area to scan is from xl,yl to xu,yu */
 	int xl = GB((x - COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS);
 	int xu = GB((x + COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS);
@@ -456,6 +465,33 @@ bool HasVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc)
 	return VehicleFromPosXY(x, y, data, proc, true) != nullptr;
 }
 
+/**
+ * Find road vehicles around a specific location. It calls \a proc with the
+ * road vehicles of every part of the vehicle hash that FindVehicleOnPosXY
+ * would search, so the same rules for finding the "best one" apply.
+ * @param x    The X location on the map
+ * @param y    The Y location on the map
+ * @param data Arbitrary data passed to proc
+ * @param proc The proc that is called with the road vehicles of a part of the hash.
+ */
+void FindRoadVehiclesOnPosXY(int x, int y, void *data, VehiclesFromPosProc *proc)
+{
+	/* Hash area to scan is from xl,yl to xu,yu */
+	int xl = GB((x - COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS);
+	int xu = GB((x + COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS);
+	int yl = GB((y - COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS) << HASH_BITS;
+	int yu = GB((y + COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS) << HASH_BITS;
+
+	for (int hy = yl; ; hy = (hy + (1 << HASH_BITS)) & (HASH_MASK << HASH_BITS)) {
+		for (int hx = xl; ; hx = (hx + 1) & HASH_MASK) {
+			const std::vector<Vehicle *> &bucket = _road_vehicle_tile_hash[(hx + hy) & TOTAL_HASH_MASK];
+			if (!bucket.empty()) proc(bucket.data(), bucket.size(), data);
+			if (hx == xu) break;
+		}
+		if (hy == yu) break;
+	}
+}
+
 /**
  * Helper function for FindVehicleOnPos/HasVehicleOnPos.
  * @note Do not call this function directly!
@@ -624,6 +660,18 @@ static void UpdateVehicleTileHash(Vehicle *v, bool remove)
 
 	if (old_hash == new_hash) return;
 
+	if (v->type == VEH_ROAD) {
+		/* Move between the same buckets of the road vehicle hash; the order within a bucket does not matter */
+		if (old_hash != nullptr) {
+			std::vector<Vehicle *> &bucket = _road_vehicle_tile_hash[old_hash - _vehicle_tile_hash];
+			auto it = std::find(bucket.begin(), bucket.end(), v);
+			assert(it != bucket.end());
+			*it = bucket.back();
+			bucket.pop_back();
+		}
+		if (new_hash != nullptr) _road_vehicle_tile_hash[new_hash - _vehicle_tile_hash].push_back(v);
+	}
+
 	/* Remove from the old position in the hash table */
 	if (old_hash != nullptr) {
 		if (v->hash_tile_next != nullptr) v->hash_tile_next->hash_tile_prev = v->hash_tile_prev;
@@ -676,6 +724,7 @@ void ResetVehicleHash()
 	FOR_ALL_VEHICLES(v) { v->hash_tile_current = nullptr; }
 	memset(_vehicle_viewport_hash, 0, sizeof(_vehicle_viewport_hash));
 	memset(_vehicle_tile_hash, 0, sizeof(_vehicle_tile_hash));
+	for (std::vector<Vehicle *> &bucket : _road_vehicle_tile_hash) bucket.clear();
 }
 
 void ResetVehicleColourMap()
@@ -941,9 +990,104 @@ static void RunVehicleDayProc()
 	}
 }
 
+/** Request to search the path of a vehicle beyond its cached path. */
+struct PathPrefetchRequest {
+	VehicleID veh;  ///< The road vehicle or ship.
+	TileIndex tile; ///< Tile the cached path starts from.
+	Trackdir td;    ///< Trackdir the cached path starts from.
+	size_t size;    ///< Length of the cached path when the request was made.
+};
+
+static std::vector<PathPrefetchRequest> _path_prefetch_requests; ///< Path searches requested during the vehicle ticks of the current tick.
+
+/**
+ * Request the path beyond the cached path of a road vehicle or ship to be searched
+ * at the end of the vehicle ticks, so it is known before the vehicle needs it.
+ * @param v The vehicle that just took a step of its cached path.
+ * @param tile Tile the rest of the cached path starts from.
+ * @param td Trackdir the rest of the cached path starts from.
+ */
+void RequestPathPrefetch(const Vehicle *v, TileIndex tile, Trackdir td)
+{
+	assert(v->type == VEH_ROAD || v->type == VEH_SHIP);
+	size_t size = v->type == VEH_ROAD ? RoadVehicle::From(v)->path.size() : Ship::From(v)->path.size();
+	if (!_path_prefetch_requests.empty() && _path_prefetch_requests.back().veh == v->index) _path_prefetch_requests.pop_back();
+	_path_prefetch_requests.push_back({v->index, tile, td, size});
+}
+
+/**
+ * Search the paths requested during the vehicle ticks and append them to the
+ * cached paths of the vehicles. The searches only read the game state, which
+ * does not change until all of them are done, so they run on the worker threads
+ * and each result only depends on the state at the end of the vehicle ticks.
+ * The results are committed in the order of the requests, all within the same
+ * tick, so the outcome does not depend on the number of threads.
+ */
+static void PrefetchVehiclePaths()
+{
+	if (_path_prefetch_requests.empty()) return;
+
+	static std::vector<RoadVehPathCache> road_ahead;
+	static std::vector<ShipPathCache> ship_ahead;
+	road_ahead.assign(_path_prefetch_requests.size(), RoadVehPathCache());
+	ship_ahead.assign(_path_prefetch_requests.size(), ShipPathCache());
+
+	/* Drop requests whose vehicle or cached path changed after making them. */
+	for (PathPrefetchRequest &req : _path_prefetch_requests) {
+		const Vehicle *v = Vehicle::GetIfValid(req.veh);
+		bool valid = false;
+		if (v != nullptr && v->dest_tile != 0 && _settings_game.pf.path_prefetch) {
+			if (v->type == VEH_ROAD) {
+				valid = _settings_game.pf.pathfinder_for_roadvehs == VPF_YAPF && RoadVehicle::From(v)->IsFrontEngine() && RoadVehicle::From(v)->path.size() == req.size;
+			} else if (v->type == VEH_SHIP) {
+				valid = _settings_game.pf.pathfinder_for_ships == VPF_YAPF && Ship::From(v)->path.size() == req.size;
+			}
+		}
+		if (!valid || req.size == 0) req.veh = INVALID_VEHICLE;
+	}
+
+	auto search = [](size_t first, size_t last) {
+		for (size_t i = first; i < last; i++) {
+			const PathPrefetchRequest &req = _path_prefetch_requests[i];
+			if (req.veh == INVALID_VEHICLE) continue;
+
+			const Vehicle *v = Vehicle::Get(req.veh);
+			if (v->type == VEH_ROAD) {
+				YapfRoadVehicleFindPathAhead(RoadVehicle::From(v), road_ahead[i]);
+			} else {
+				YapfShipFindPathAhead(Ship::From(v), req.tile, req.td, ship_ahead[i]);
+			}
+		}
+	};
+	/* The pathfinder statistics of the YAPF debug output are not thread safe. */
+	if (_debug_yapf_level >= 2) {
+		search(0, _path_prefetch_requests.size());
+	} else {
+		RunOnWorkerThreads(_path_prefetch_requests.size(), 1, search);
+	}
+
+	for (size_t i = 0; i < _path_prefetch_requests.size(); i++) {
+		const PathPrefetchRequest &req = _path_prefetch_requests[i];
+		if (req.veh == INVALID_VEHICLE) continue;
+
+		Vehicle *v = Vehicle::Get(req.veh);
+		if (v->type == VEH_ROAD) {
+			RoadVehPathCache &path = RoadVehicle::From(v)->path;
+			path.td.insert(path.td.end(), road_ahead[i].td.begin(), road_ahead[i].td.end());
+			path.tile.insert(path.tile.end(), road_ahead[i].tile.begin(), road_ahead[i].tile.end());
+		} else {
+			ShipPathCache &path = Ship::From(v)->path;
+			path.insert(path.end(), ship_ahead[i].begin(), ship_ahead[i].end());
+		}
+	}
+
+	_path_prefetch_requests.clear();
+}
+
 void CallVehicleTicks()
 {
 	_vehicles_to_autoreplace.clear();
+	YapfResetJunctionSearchMisses(true);
 
 	RunVehicleDayProc();
 
@@ -1027,6 +1171,9 @@ void CallVehicleTicks()
 		}
 	}
 
+	PrefetchVehiclePaths();
+	YapfResetJunctionSearchMisses(false);
+
 	Backup<CompanyID> cur_company(_current_company, FILE_LINE);
 	for (auto &it : _vehicles_to_autoreplace) {
 		v = it.first;
@@ -39,6 +39,7 @@ template <VehicleType T>
 bool IsValidImageIndex(uint8 image_index);
 
 typedef Vehicle *VehicleFromPosProc(Vehicle *v, void *data);
+typedef void VehiclesFromPosProc(Vehicle * const *vehicles, size_t count, void *data);
 
 void VehicleServiceInDepot(Vehicle *v);
 uint CountVehiclesInChain(const Vehicle *v);
@@ -46,6 +47,7 @@ void FindVehicleOnPos(TileIndex tile, void *data, VehicleFromPosProc *proc);
 void FindVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc);
 bool HasVehicleOnPos(TileIndex tile, void *data, VehicleFromPosProc *proc);
 bool HasVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc);
+void FindRoadVehiclesOnPosXY(int x, int y, void *data, VehiclesFromPosProc *proc);
 void CallVehicleTicks();
 uint8 CalcPercentVehicleFilled(const Vehicle *v, StringID *colour);
 
@@ -66,6 +68,7 @@ void DecreaseVehicleValue(Vehicle *v);
 void CheckVehicleBreakdown(Vehicle *v);
 void AgeVehicle(Vehicle *v);
 void VehicleEnteredDepotThisTick(Vehicle *v);
+void RequestPathPrefetch(const Vehicle *v, TileIndex tile, Trackdir td);
 
 UnitID GetFreeUnitNumber(VehicleType type);
 
@@ -30,6 +30,7 @@
 #include "company_base.h"
 #include "water.h"
 #include "company_gui.h"
+#include "signal_func.h"
 
 #include "table/strings.h"
 
@@ -293,6 +294,7 @@ CommandCost CmdBuildRailWaypoint(TileIndex start_tile, DoCommandFlag flags, uint
 			DeallocateSpecFromStation(wp, old_specindex);
 			YapfNotifyTrackLayoutChange(tile, AxisToTrack(axis));
 		}
+		InvalidateSignalSegmentCache();
 		DirtyCompanyInfrastructureWindows(wp->owner);
 	}
 
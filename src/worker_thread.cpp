@@ -0,0 +1,187 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file worker_thread.cpp Pool of worker threads for splitting independent work of the game loop. */
+
+#include "stdafx.h"
+#include "worker_thread.h"
+#include "thread.h"
+#include "core/math_func.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "safeguards.h"
+
+uint8 _worker_threads; ///< Number of threads to use for parallel work, including the game thread; 0 means one per core.
+
+static std::vector<std::thread> _workers;         ///< The running worker threads.
+static std::mutex _job_owner;                     ///< Held by the thread whose job the pool is running.
+static std::mutex _worker_lock;                   ///< Lock protecting the job state below.
+static std::condition_variable _worker_wake;      ///< Signalled when a new job is available or the workers should stop.
+static std::condition_variable _worker_done;      ///< Signalled when the last worker finished its part of a job.
+static const WorkerRangeProc *_job_proc;          ///< Function of the current job.
+static size_t _job_count;                         ///< Number of items of the current job.
+static size_t _job_chunk;                         ///< Number of items a thread claims at once.
+static std::atomic<size_t> _job_next;             ///< First item of the current job that has not been claimed yet.
+static uint _job_generation;                      ///< Sequence number of the current job.
+static uint _job_busy;                            ///< Number of workers that did not finish the current job yet.
+static bool _workers_exit;                        ///< Whether the workers should stop.
+static uint _workers_threads;                     ///< Thread count the workers were started for.
+
+/**
+ * Get the number of threads, including the game thread, that are used for parallel work.
+ * @return The thread count; 1 means everything is done on the game thread.
+ */
+uint GetWorkerThreadCount()
+{
+#ifdef NO_THREADS
+	return 1;
+#else
+	if (_worker_threads != 0) return _worker_threads;
+	return Clamp<uint>(std::thread::hardware_concurrency(), 1, UINT8_MAX);
+#endif
+}
+
+/** Claim and process chunks of the current job until none are left. */
+static void ProcessJobChunks()
+{
+	for (;;) {
+		size_t first = _job_next.fetch_add(_job_chunk);
+		if (first >= _job_count) return;
+		(*_job_proc)(first, min(first + _job_chunk, _job_count));
+	}
+}
+
+/**
+ * Main loop of a worker thread.
+ * @param generation Sequence number of the last job that was started before this worker.
+ */
+static void WorkerThreadLoop(uint generation)
+{
+	std::unique_lock<std::mutex> lock(_worker_lock);
+	for (;;) {
+		_worker_wake.wait(lock, [&generation]() { return _workers_exit || _job_generation != generation; });
+		if (_workers_exit) return;
+		generation = _job_generation;
+
+		lock.unlock();
+		ProcessJobChunks();
+		lock.lock();
+
+		if (--_job_busy == 0) _worker_done.notify_one();
+	}
+}
+
+/** Stop and join all worker threads; the caller must own the pool. */
+static void StopWorkers()
+{
+	_workers_threads = 0;
+	if (_workers.empty()) return;
+
+	{
+		std::lock_guard<std::mutex> lock(_worker_lock);
+		_workers_exit = true;
+	}
+	_worker_wake.notify_all();
+	for (std::thread &t : _workers) t.join();
+	_workers.clear();
+}
+
+/**
+ * Make sure the number of running workers matches the configured thread count.
+ * @param threads Number of threads, including the game thread, to use.
+ */
+static void StartWorkerThreads(uint threads)
+{
+	if (_workers_threads == threads) return;
+
+	StopWorkers();
+	_workers_exit = false;
+	_workers_threads = threads;
+	for (uint i = 1; i < threads; i++) {
+		std::thread t;
+		if (!StartNewThread(&t, "ottd:worker", &WorkerThreadLoop, (uint)_job_generation)) break;
+		_workers.push_back(std::move(t));
+	}
+}
+
+/**
+ * Stop and join all worker threads.
+ */
+void StopWorkerThreads()
+{
+	std::lock_guard<std::mutex> owner(_job_owner);
+	StopWorkers();
+}
+
+/**
+ * Keep the pool from starting any job, e.g. while forking the game. Jobs that
+ * other threads start meanwhile are processed on those threads.
+ * The calling thread must not start a job itself until #ReleaseWorkerThreads.
+ * @return True if the pool was idle and is now held, false if it is running a job.
+ */
+bool TryHoldWorkerThreads()
+{
+	return _job_owner.try_lock();
+}
+
+/** Let the pool start jobs again after a successful #TryHoldWorkerThreads. */
+void ReleaseWorkerThreads()
+{
+	_job_owner.unlock();
+}
+
+/**
+ * Process \a count independent items, spreading them over the worker threads.
+ * The game thread takes part in the work and this function only returns once
+ * every item has been processed, so the caller can commit the results right after.
+ * The items must not touch any state that another item could be touching.
+ * The pool runs one job at a time; when it is busy with a job of another
+ * thread, e.g. the savegame thread, the items are processed on this thread.
+ * @param count Number of items to process.
+ * @param chunk Number of items a thread claims at once; at least 1.
+ * @param proc  Function to process a range of items.
+ */
+void RunOnWorkerThreads(size_t count, size_t chunk, const WorkerRangeProc &proc)
+{
+	assert(chunk > 0);
+	if (count == 0) return;
+
+	uint threads = GetWorkerThreadCount();
+	std::unique_lock<std::mutex> owner(_job_owner, std::defer_lock);
+	if (threads <= 1 || count <= chunk || !owner.try_lock()) {
+		proc(0, count);
+		return;
+	}
+
+	StartWorkerThreads(threads);
+	if (_workers.empty()) {
+		proc(0, count);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_worker_lock);
+		_job_proc = &proc;
+		_job_count = count;
+		_job_chunk = chunk;
+		_job_next = 0;
+		_job_busy = (uint)_workers.size();
+		_job_generation++;
+	}
+	_worker_wake.notify_all();
+
+	ProcessJobChunks();
+
+	std::unique_lock<std::mutex> lock(_worker_lock);
+	_worker_done.wait(lock, []() { return _job_busy == 0; });
+	_job_proc = nullptr;
+}
@@ -0,0 +1,32 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file worker_thread.h Pool of worker threads for splitting independent work of the game loop. */
+
+#ifndef WORKER_THREAD_H
+#define WORKER_THREAD_H
+
+#include <functional>
+
+/**
+ * Function processing a range of work items.
+ * @param first First item to process.
+ * @param last  One past the last item to process.
+ */
+typedef std::function<void(size_t first, size_t last)> WorkerRangeProc;
+
+extern uint8 _worker_threads;
+
+uint GetWorkerThreadCount();
+void RunOnWorkerThreads(size_t count, size_t chunk, const WorkerRangeProc &proc);
+bool TryHoldWorkerThreads();
+void ReleaseWorkerThreads();
+void StopWorkerThreads();
+
+#endif /* WORKER_THREAD_H */